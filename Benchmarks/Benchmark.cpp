@@ -0,0 +1,156 @@
+#include "Benchmark.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+BenchmarkOptions Benchmark::parseArgs(int argc, char** argv) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--runs" && hasValue) {
+            options.runs = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--warmup" && hasValue) {
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (arg == "--max-seconds" && hasValue) {
+            options.maxSeconds = std::atof(argv[++i]);
+        }
+        else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        }
+        else if (arg == "--json" && hasValue) {
+            options.json = argv[++i];
+        }
+        else if (arg == "--tag" && hasValue) {
+            options.tag = argv[++i];
+        }
+        else if (arg == "--trace" && hasValue) {
+            options.trace = argv[++i];
+        }
+        else if (arg == "--quick") {
+            options.quick = true;
+        }
+        else {
+            std::cerr << "unknown argument " << arg << std::endl;
+            std::cerr << "usage: " << argv[0] << " [--runs N] [--warmup N] [--max-seconds S] [--filter NAME] [--json FILE] [--tag TAG] [--trace FILE] [--quick]" << std::endl;
+            std::exit(1);
+        }
+    }
+    options.minRuns = std::min(options.minRuns, options.runs);
+    return options;
+}
+
+double Benchmark::quantile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    const size_t rank = (size_t)std::ceil(q*sorted.size());
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+bool Benchmark::run(const std::string& name, const std::string& params, const std::string& unit, double items, const std::function<void()>& fn) {
+    if (!enabled(name)) {
+        return false;
+    }
+    for (int i = 0; i < this->options_.warmup; ++i) {
+        fn();
+    }
+
+    std::vector<double> times;
+    times.reserve(this->options_.runs);
+    const double frequency = getTickFrequency();
+    const int64_t start = getTickCount();
+    for (int i = 0; i < this->options_.runs; ++i) {
+        const int64_t t = getTickCount();
+        fn();
+        times.push_back(1000.0*(getTickCount() - t)/frequency);
+        if (i + 1 >= this->options_.minRuns && (getTickCount() - start)/frequency > this->options_.maxSeconds) {
+            break;
+        }
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.params = params;
+    result.unit = unit;
+    result.items = items;
+    result.runs = (int)times.size();
+    result.mean = std::accumulate(times.begin(), times.end(), 0.0)/times.size();
+    std::sort(times.begin(), times.end());
+    result.median = quantile(times, 0.5);
+    result.p99 = result.hasP99() ? quantile(times, 0.99) : 0;
+    result.min = times.front();
+    result.max = times.back();
+
+    std::cout << std::left << std::setw(36) << name << std::setw(14) << params << std::right << std::fixed << std::setprecision(3)
+              << " median " << std::setw(10) << result.median << " ms";
+    if (result.hasP99()) {
+        std::cout << "  p99 " << std::setw(10) << result.p99 << " ms";
+    }
+    else {
+        std::cout << "  p99 " << std::setw(10) << "n/a" << "   ";
+    }
+    std::cout << "  max " << std::setw(10) << result.max << " ms";
+    if (items > 0) {
+        std::cout << "  " << std::setw(10) << std::setprecision(1) << result.throughput() << (unit == "pixels" ? " MPix/s" : " M" + unit + "/s");
+    }
+    std::cout << "  (" << result.runs << " runs)" << std::endl;
+    this->results_.push_back(result);
+    return true;
+}
+
+//names & params are plain ascii, but escape quotes & backslashes anyway.
+static std::string jsonString(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+bool Benchmark::writeJson(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    const std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    file << std::setprecision(6);
+    file << "{\n";
+    file << "  \"tag\": " << jsonString(this->options_.tag) << ",\n";
+    file << "  \"date\": " << jsonString(date) << ",\n";
+    file << "  \"opencv\": " << jsonString(CV_VERSION) << ",\n";
+    file << "  \"cpus\": " << getNumberOfCPUs() << ",\n";
+    file << "  \"threads\": " << getNumThreads() << ",\n";
+    file << "  \"results\": [\n";
+    for (size_t i = 0; i < this->results_.size(); ++i) {
+        const BenchmarkResult& r = this->results_[i];
+        std::ostringstream p99;
+        p99 << std::setprecision(6);
+        if (r.hasP99()) {
+            p99 << r.p99;
+        }
+        else {
+            p99 << "null";
+        }
+        file << "    {\"name\": " << jsonString(r.name) << ", \"params\": " << jsonString(r.params)
+             << ", \"unit\": " << jsonString(r.unit) << ", \"items\": " << (int64_t)r.items << ", \"runs\": " << r.runs
+             << ", \"median_ms\": " << r.median << ", \"p99_ms\": " << p99.str() << ", \"mean_ms\": " << r.mean
+             << ", \"min_ms\": " << r.min << ", \"max_ms\": " << r.max << ", \"throughput_m_per_s\": " << r.throughput() << "}"
+             << (i + 1 < this->results_.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n";
+    file << "}\n";
+    return bool(file);
+}
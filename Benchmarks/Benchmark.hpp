@@ -0,0 +1,64 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cv;
+
+//timings of one benchmark, in milliseconds per run.
+struct BenchmarkResult
+{
+    std::string name;           //what is measured, e.g. "rotation.rotate.bilinear".
+    std::string params;         //what it ran on, e.g. "1920x1080".
+    std::string unit;           //what items are: "pixels" or "elements".
+    double items = 0;           //items processed per run, 0 if throughput doesn't apply.
+    int runs = 0;
+    double median = 0, p99 = 0, mean = 0, min = 0, max = 0;
+    //below 100 runs the nearest rank p99 is just the max (e.g. rank ceil(0.99*30) = 30), so it's only reported from there on.
+    static constexpr int minP99Runs = 100;
+    bool hasP99() const { return this->runs >= minP99Runs; }
+    //millions of items per second, at the median.
+    double throughput() const { return this->median > 0 ? this->items/(this->median*1e3) : 0; }
+};
+
+//how long to run each benchmark & which ones.
+struct BenchmarkOptions
+{
+    int warmup = 2;             //untimed runs first, to fill caches & let buffers be allocated.
+    //timed runs. Enough for a p99 by default, and maxSeconds never stops a benchmark before minRuns: every result has
+    //a p99 unless --runs is lowered below BenchmarkResult::minP99Runs explicitly (then minRuns = runs).
+    int runs = BenchmarkResult::minP99Runs;
+    int minRuns = BenchmarkResult::minP99Runs;
+    double maxSeconds = 2.0;    //only ends a benchmark past minRuns, i.e. caps --runs above the default.
+    std::string filter;         //only run benchmarks whose name contains this.
+    std::string json;           //write the results to this file as well.
+    std::string tag;            //free form, e.g. a version or commit, copied into the JSON.
+    std::string trace;          //benchmark_suite: record the traced stages & write them to this file as a Chrome trace.
+    bool quick = false;         //skip the largest sizes.
+};
+
+//A headless micro benchmark runner: times a function over many runs & reports the median, p99 & throughput instead
+//of a mean, so a few slow runs (page faults, another process) don't hide a regression. p99 is n/a (null in the JSON)
+//only if --runs asks for fewer than BenchmarkResult::minP99Runs runs, the max is always there.
+class Benchmark
+{
+    public:
+        explicit Benchmark(const BenchmarkOptions& options) : options_{options} {}
+        //--runs N, --warmup N, --max-seconds S, --filter NAME, --json FILE, --tag TAG, --trace FILE, --quick
+        static BenchmarkOptions parseArgs(int argc, char** argv);
+        const BenchmarkOptions& options() const { return this->options_; }
+        bool enabled(const std::string& name) const { return this->options_.filter.empty() || name.find(this->options_.filter) != std::string::npos; }
+        //times fn, prints a line & keeps the result. Skipped (returns false) if the name doesn't pass the filter.
+        bool run(const std::string& name, const std::string& params, const std::string& unit, double items, const std::function<void()>& fn);
+        const std::vector<BenchmarkResult>& results() const { return this->results_; }
+        bool writeJson(const std::string& path) const;
+        //value at quantile q (0..1) of sorted samples, nearest rank.
+        static double quantile(const std::vector<double>& sorted, double q);
+        static std::string sizeString(Size size) { return std::to_string(size.width) + "x" + std::to_string(size.height); }
+    private:
+        BenchmarkOptions options_;
+        std::vector<BenchmarkResult> results_;
+};
@@ -0,0 +1,490 @@
+#include <numeric>
+#include "Benchmark.hpp"
+#include "../OpenCV/rotation.h"
+#include "../OpenCV/GaussPyramid.hpp"
+#include "../OpenCV/Trace.hpp"
+#include "../WorkingwithSTL/template_containers.hpp"
+
+using namespace std;
+
+/*
+    Headless benchmarks of the rotation, transform, pixel access & pyramid kernels and the STL containers, on synthetic
+    images so they run anywhere (no GUI, no sample files). Prints median / p99 / max / throughput per benchmark, --json FILE
+    also writes them out to compare between versions. Each benchmark runs at least 100 times for the p99, so a full run
+    takes a while: --filter or --quick narrow it (--runs below 100 too, but then p99 is n/a).
+
+    build (from the repo root):
+        g++ -O3 -std=c++17 -march=native Benchmarks/Benchmark.cpp Benchmarks/benchmark_suite.cpp OpenCV/rotation.cpp \
+            OpenCV/GaussPyramid.cpp OpenCV/ScaleSpace.cpp OpenCV/PyramidStorage.cpp OpenCV/TaskScheduler.cpp \
+            OpenCV/ExtremaDetector.cpp OpenCV/Trace.cpp `pkg-config --cflags --libs opencv4` -pthread -o benchmark_suite
+    run:
+        ./benchmark_suite --json results.json --tag v1.2
+
+    stage tracing (OpenCV/Trace.hpp): add -DSLAM_TRACE to the build line above to compile the TRACE_SCOPE hooks in, then
+        ./benchmark_suite --trace trace.json --filter pyramid --quick
+    records every traced stage of the run, writes trace.json (open in chrome://tracing or ui.perfetto.dev) and prints the
+    per stage summary. Each thread keeps its last Trace::bufferSize events, so narrow long runs down with --filter.
+    The hooks add a little to every timing, compare timings of traced builds only with each other.
+*/
+
+//a smooth pattern with some texture & noise, so pyramids find keypoints & interpolation sees real gradients.
+static Mat syntheticImage(Size size, int seed = 0) {
+    Mat img(size, CV_8UC1);
+    RNG rng(seed);
+    for (int y = 0; y < size.height; ++y) {
+        uchar* row = img.ptr<uchar>(y);
+        for (int x = 0; x < size.width; ++x) {
+            const double v = 128 + 60*std::sin(x*0.05)*std::cos(y*0.07) + 30*std::sin((x + y)*0.31) + rng.uniform(-10.0, 10.0);
+            row[x] = saturate_cast<uchar>(v);
+        }
+    }
+    return img;
+}
+
+static vector<Size> imageSizes(const BenchmarkOptions& options) {
+    vector<Size> sizes = {Size(640, 480), Size(1280, 720), Size(1920, 1080)};
+    if (!options.quick) {
+        sizes.push_back(Size(3840, 2160));
+    }
+    return sizes;
+}
+
+static void rotationBenchmarks(Benchmark& bench) {
+    for (Size size : imageSizes(bench.options())) {
+        Mat img = syntheticImage(size);
+        const string params = Benchmark::sizeString(size);
+        const double pixels = size.area();
+        const Point2f center(size.width/2.0f, size.height/2.0f);
+        const Point2f angles = SLAM::Rotation::cos_sin_of_angle(30.0f);
+        Mat rotated;
+
+        bench.run("rotation.rotate.nearest", params, "pixels", pixels, [&]{ SLAM::Rotation::rotate(img, rotated, center, angles, INTER_NEAREST); });
+        bench.run("rotation.rotate.bilinear", params, "pixels", pixels, [&]{ SLAM::Rotation::rotate(img, rotated, center, angles, INTER_LINEAR); });
+        //the same mapping, for reference.
+        Mat rotation_mat = getRotationMatrix2D(center, -30.0, 1.0);
+        bench.run("rotation.warpAffine.bilinear", params, "pixels", pixels, [&]{ warpAffine(img, rotated, rotation_mat, size, INTER_LINEAR | WARP_INVERSE_MAP); });
+
+        //quarter turns are copies: through rotate() (same canvas), the whole image, and cv::rotate for reference.
+        const Point2i pixelCenter(size.width/2, size.height/2);
+        const Point2f quarter = SLAM::Rotation::cos_sin_of_angle(90.0f);
+        bench.run("rotation.rotate.90", params, "pixels", pixels, [&]{ SLAM::Rotation::rotate(img, rotated, pixelCenter, quarter, INTER_LINEAR); });
+        bench.run("rotation.rotateQuarter.90", params, "pixels", pixels, [&]{ SLAM::Rotation::rotateQuarter(img, rotated, 1); });
+        bench.run("rotation.rotateQuarter.180", params, "pixels", pixels, [&]{ SLAM::Rotation::rotateQuarter(img, rotated, 2); });
+        bench.run("rotation.cv_rotate.90", params, "pixels", pixels, [&]{ cv::rotate(img, rotated, ROTATE_90_COUNTERCLOCKWISE); });
+        bench.run("rotation.flip.horizontal", params, "pixels", pixels, [&]{ SLAM::Rotation::flip(img, rotated, 1); });
+    }
+
+    //windows around keypoints, in a 1080p frame.
+    Mat img = syntheticImage(Size(1920, 1080));
+    const int numWindows = 1000;
+    const int windowSize = 16;
+    SLAM::RotatedWindowArray windows;
+    vector<Point2i> centers;
+    RNG rng(1);
+    for (int i = 0; i < numWindows; ++i) {
+        const Point2i c(rng.uniform(windowSize, img.cols - windowSize), rng.uniform(windowSize, img.rows - windowSize));
+        windows.push_back((float)c.x, (float)c.y, (float)rng.uniform(0, 360), (float)windowSize);
+        centers.push_back(c);
+    }
+    const string params = to_string(numWindows) + "x" + to_string(windowSize) + "x" + to_string(windowSize);
+    const double pixels = double(numWindows)*windowSize*windowSize;
+
+    bench.run("rotation.getRotatedWindow", params, "pixels", pixels, [&]{
+        for (int i = 0; i < numWindows; ++i) {
+            SLAM::Rotation::getRotatedWindow(img, centers[i], windowSize, windows.angle[i]);
+        }
+    });
+    Mat patches;
+    bench.run("rotation.extractWindows.nearest", params, "pixels", pixels, [&]{ SLAM::Rotation::extractWindows(img, windows, windowSize, patches, INTER_NEAREST); });
+    bench.run("rotation.extractWindows.bilinear", params, "pixels", pixels, [&]{ SLAM::Rotation::extractWindows(img, windows, windowSize, patches, INTER_LINEAR); });
+    bench.run("rotation.doubleCrop", params, "pixels", pixels, [&]{
+        for (int i = 0; i < numWindows; ++i) {
+            SLAM::Rotation::doubleCrop(img, centers[i], windowSize, windows.angle[i]);
+        }
+    });
+}
+
+//8K frames, where the row order rotation reads src diagonally far outside the cache: rows vs L2 sized tiles, serial & on
+//every core, against warpAffine. Skipped with --quick.
+static void largeRotationBenchmarks(Benchmark& bench) {
+    if (bench.options().quick) {
+        return;
+    }
+    const Size size(7680, 4320);
+    const double pixels = size.area();
+    const Point2f center(size.width/2.0f, size.height/2.0f);
+    for (int type : {CV_8UC1, CV_32FC1}) {
+        Mat img;
+        syntheticImage(size).convertTo(img, type);
+        Mat rotated;
+        for (float angle : {30.0f, 60.0f}) {
+            const string params = Benchmark::sizeString(size) + (type == CV_8UC1 ? "/8u/" : "/32f/") + to_string(int(angle));
+            const Point2f angles = SLAM::Rotation::cos_sin_of_angle(angle);
+            bench.run("rotation.8k.rotate", params, "pixels", pixels, [&]{ SLAM::Rotation::rotate(img, rotated, center, angles, INTER_LINEAR); });
+            bench.run("rotation.8k.rotateTiled", params, "pixels", pixels, [&]{ SLAM::Rotation::rotateTiled(img, rotated, center, angles, INTER_LINEAR, Scalar(), 1); });
+            bench.run("rotation.8k.rotateTiled.parallel", params, "pixels", pixels, [&]{ SLAM::Rotation::rotateTiled(img, rotated, center, angles, INTER_LINEAR, Scalar(), 0); });
+            Mat rotation_mat = getRotationMatrix2D(center, -angle, 1.0);
+            bench.run("rotation.8k.warpAffine", params, "pixels", pixels, [&]{ warpAffine(img, rotated, rotation_mat, size, INTER_LINEAR | WARP_INVERSE_MAP); });
+        }
+    }
+}
+
+static void transformBenchmarks(Benchmark& bench) {
+    const int n = 500000;
+    SLAM::PointArray points, out;
+    RNG rng(3);
+    for (int i = 0; i < n; ++i) {
+        points.push_back(rng.uniform(0.0f, 1920.0f), rng.uniform(0.0f, 1080.0f));
+    }
+    const string params = to_string(n);
+    const Point2f center(960.0f, 540.0f);
+    const Point2f angles = SLAM::Rotation::cos_sin_of_angle(30.0f);
+    const SLAM::Transform rigid = SLAM::Transform::rotation(center, angles);
+    const SLAM::Transform homography = SLAM::Transform::homography(SLAM::linalg::Mat33f{1.1f, 0.02f, 3.0f, -0.01f, 0.95f, -2.0f, 1e-5f, 2e-5f, 1.0f});
+    out.resize(n);
+
+    //one point at a time, the way it was done before Transform.
+    bench.run("transform.rotate_pt_CW", params, "points", n, [&]{
+        for (int i = 0; i < n; ++i) {
+            const Point2f p = SLAM::Rotation::rotate_pt_CW(Point2f(points.x[i], points.y[i]), center, angles);
+            out.x[i] = p.x;
+            out.y[i] = p.y;
+        }
+    });
+    bench.run("transform.rigid", params, "points", n, [&]{ rigid.apply(points, out); });
+    bench.run("transform.rigid.parallel", params, "points", n, [&]{ rigid.apply(points, out, true); });
+    bench.run("transform.homography", params, "points", n, [&]{ homography.apply(points, out); });
+    bench.run("transform.homography.parallel", params, "points", n, [&]{ homography.apply(points, out, true); });
+}
+
+//per pixel access through Mat::at, row pointers & MatView, on an ROI so the rows have padding. The 8U stores go through
+//a uchar*, which can alias the Mat, so at() has to load data & step again for every pixel.
+static void matViewBenchmarks(Benchmark& bench) {
+    for (const Size& size : imageSizes(bench.options())) {
+        const Mat whole = syntheticImage(Size(size.width + 2, size.height + 2), 6);
+        const Mat src = whole(Rect(1, 1, size.width, size.height));
+        Mat dst(size, CV_8UC1);
+        const string params = Benchmark::sizeString(size);
+        const double pixels = size.area();
+        uint64_t total = 0;
+
+        bench.run("matview.invert.at", params, "pixels", pixels, [&]{
+            for (int y = 0; y < src.rows; ++y) {
+                for (int x = 0; x < src.cols; ++x) {
+                    dst.at<uchar>(y, x) = 255 - src.at<uchar>(y, x);
+                }
+            }
+        });
+        bench.run("matview.invert.ptr", params, "pixels", pixels, [&]{
+            for (int y = 0; y < src.rows; ++y) {
+                const uchar* in = src.ptr<uchar>(y);
+                uchar* out = dst.ptr<uchar>(y);
+                for (int x = 0; x < src.cols; ++x) {
+                    out[x] = 255 - in[x];
+                }
+            }
+        });
+        bench.run("matview.invert.view", params, "pixels", pixels, [&]{
+            const SLAM::MatView<const uchar> in(src);
+            const SLAM::MatView<uchar> out(dst);
+            for (int y = 0; y < in.rows(); ++y) {
+                std::transform(in.row(y).begin(), in.row(y).end(), out[y], [](uchar v) { return uchar(255 - v); });
+            }
+        });
+        bench.run("matview.sum.at", params, "pixels", pixels, [&]{
+            for (int y = 0; y < src.rows; ++y) {
+                for (int x = 0; x < src.cols; ++x) {
+                    total += src.at<uchar>(y, x);
+                }
+            }
+        });
+        bench.run("matview.sum.rows", params, "pixels", pixels, [&]{
+            for (auto row : SLAM::MatView<const uchar>(src).eachRow()) {
+                total = std::accumulate(row.begin(), row.end(), total);
+            }
+        });
+        //every pixel through the flat iterator, across the padding.
+        bench.run("matview.sum.iterator", params, "pixels", pixels, [&]{
+            const SLAM::MatView<const uchar> in(src);
+            total = std::accumulate(in.begin(), in.end(), total);
+        });
+        //keeps the sums alive.
+        if (total == 42) {
+            cout << total << endl;
+        }
+    }
+}
+
+static void pyramidBenchmarks(Benchmark& bench) {
+    const int numOctaves = 3;
+    const float sigma = 1.6f;
+    const char* names[] = {"float32", "float16", "fixed16"};
+    const PyramidPrecision precisions[] = {PyramidPrecision::Float32, PyramidPrecision::Float16, PyramidPrecision::Fixed16};
+
+    for (Size size : imageSizes(bench.options())) {
+        Mat img = syntheticImage(size);
+        const string params = Benchmark::sizeString(size);
+        const double pixels = size.area();
+
+        for (int p = 0; p < 3; ++p) {
+            for (int threads : {1, 0}) {
+                const string name = string("pyramid.build.") + names[p] + (threads == 1 ? "" : ".parallel");
+                if (!bench.enabled(name)) {
+                    continue;
+                }
+                PyramidOptions options;
+                options.precision = precisions[p];
+                options.numThreads = threads;
+                GaussPyramid pyramid(img, numOctaves, sigma, options);
+                bench.run(name, params, "pixels", pixels, [&]{ pyramid.rebuild(img); });
+            }
+        }
+
+        //the DoG pass on its own (the fused build does it inside the blur): every level pair of every octave.
+        PyramidOptions options;
+        options.fusedDoG = false;
+        GaussPyramid pyramid(img, numOctaves, sigma, options);
+        const vector<vector<Mat>>& gaussians = pyramid.gaussPyramid();
+        vector<vector<Mat>> diffs(gaussians.size());
+        double diffPixels = 0;
+        for (size_t o = 0; o < gaussians.size(); ++o) {
+            for (size_t l = 0; l + 1 < gaussians[o].size(); ++l) {
+                diffs[o].emplace_back(gaussians[o][l].size(), gaussians[o][l].type());
+                diffPixels += gaussians[o][l].total();
+            }
+        }
+        bench.run("pyramid.Diff_of_Gauss", params, "pixels", diffPixels, [&]{
+            for (size_t o = 0; o < gaussians.size(); ++o) {
+                for (size_t l = 0; l + 1 < gaussians[o].size(); ++l) {
+                    GaussPyramid::diffRows(gaussians[o][l + 1], gaussians[o][l], diffs[o][l], 0, diffs[o][l].rows);
+                }
+            }
+        });
+        bench.run("pyramid.build.unfused", params, "pixels", pixels, [&]{ pyramid.rebuild(img); });
+
+        KeypointArray keypoints;
+        bench.run("pyramid.detectExtrema", params, "pixels", pixels, [&]{ pyramid.detectExtrema(keypoints); });
+    }
+}
+
+static void containerBenchmarks(Benchmark& bench) {
+    const int n = 1 << 20;
+    vector<int> data(n);
+    RNG rng(2);
+    for (int& v : data) {
+        v = rng.uniform(0, n);
+    }
+    const string params = to_string(n);
+    long long sum = 0;
+
+    vector<int> vec = data;
+    bench.run("stl.vector.fill", params, "elements", n, [&]{ std::fill(vec.begin(), vec.end(), 7); });
+    bench.run("stl.vector.accumulate", params, "elements", n, [&]{ sum += std::accumulate(vec.begin(), vec.end(), 0LL); });
+    //the sorts include copying the unsorted data back in.
+    bench.run("stl.vector.sort", params, "elements", n, [&]{ vec = data; std::sort(vec.begin(), vec.end()); });
+
+    IntVec intVec(vec);
+    bench.run("stl.IntVec.fill", params, "elements", n, [&]{ std::fill(intVec.begin(), intVec.end(), 7); });
+    bench.run("stl.IntVec.accumulate", params, "elements", n, [&]{ sum += std::accumulate(intVec.begin(), intVec.end(), 0LL); });
+
+    TempVec<int> tempVec(vec);
+    bench.run("stl.TempVec.fill", params, "elements", n, [&]{ std::fill(tempVec.begin(), tempVec.end(), 7); });
+    bench.run("stl.TempVec.accumulate", params, "elements", n, [&]{ sum += std::accumulate(tempVec.begin(), tempVec.end(), 0LL); });
+    bench.run("stl.TempVec.sort", params, "elements", n, [&]{
+        std::copy(data.begin(), data.end(), tempVec.begin());
+        std::sort(tempVec.begin(), tempVec.end());
+    });
+
+    //NamedTemplate iterates with plain pointers.
+    NamedTemplate<int> named(data);
+    bench.run("stl.NamedTemplate.fill", params, "elements", n, [&]{ std::fill(named.begin(), named.end(), 7); });
+    bench.run("stl.NamedTemplate.accumulate", params, "elements", n, [&]{ sum += std::accumulate(named.begin(), named.end(), 0LL); });
+    bench.run("stl.NamedTemplate.sort", params, "elements", n, [&]{
+        std::copy(data.begin(), data.end(), named.begin());
+        std::sort(named.begin(), named.end());
+    });
+
+    //keeps the sums alive.
+    if (sum == 42) {
+        cout << sum << endl;
+    }
+}
+
+//what IntVec & TempVec iterators used to be: the same pointer, tagged forward only.
+template<typename T>
+struct ForwardOnly {
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = T;
+    using pointer = T*;
+    using reference = T&;
+    T* ptr;
+    T& operator*() const { return *this->ptr; }
+    ForwardOnly& operator++() { ++this->ptr; return *this; }
+    ForwardOnly operator++(int) { ForwardOnly tmp = *this; ++this->ptr; return tmp; }
+    friend bool operator==(const ForwardOnly& a, const ForwardOnly& b) { return a.ptr == b.ptr; }
+    friend bool operator!=(const ForwardOnly& a, const ForwardOnly& b) { return a.ptr != b.ptr; }
+};
+
+//iterator tags over 10M ints (1M with --quick): forward only vs ContiguousIterator vs raw pointers.
+static void iteratorBenchmarks(Benchmark& bench) {
+    const int n = bench.options().quick ? 1000000 : 10000000;
+    vector<int> data(n);
+    RNG rng(4);
+    for (int& v : data) {
+        v = rng.uniform(0, n);
+    }
+    const string params = to_string(n);
+    IntVec intVec(data);
+    vector<int> out(n);
+
+    //(no std::distance: over a pointer the forward loop gets folded into a subtraction anyway.)
+    const ForwardOnly<int> first{intVec.vector().data()}, last{intVec.vector().data() + n};
+    bench.run("stl.iter.copy.forward", params, "elements", n, [&]{ std::copy(first, last, out.begin()); });
+    bench.run("stl.iter.copy.IntVec", params, "elements", n, [&]{ std::copy(intVec.cbegin(), intVec.cend(), out.begin()); });
+    bench.run("stl.iter.copy.pointer", params, "elements", n, [&]{ std::copy(data.data(), data.data() + n, out.data()); });
+
+    //forward iterators can't be sorted in place: copy out, sort & copy back is what they left. All of them start
+    //from the unsorted data.
+    bench.run("stl.iter.sort.forward", params, "elements", n, [&]{
+        std::copy(data.begin(), data.end(), intVec.begin());
+        vector<int> tmp(first, last);
+        std::sort(tmp.begin(), tmp.end());
+        std::copy(tmp.begin(), tmp.end(), intVec.begin());
+    });
+    bench.run("stl.iter.sort.IntVec", params, "elements", n, [&]{
+        std::copy(data.begin(), data.end(), intVec.begin());
+        std::sort(intVec.begin(), intVec.end());
+    });
+    bench.run("stl.iter.sort.pointer", params, "elements", n, [&]{
+        std::copy(data.begin(), data.end(), out.begin());
+        std::sort(out.data(), out.data() + n);
+    });
+}
+
+//the bulk:: operations on 10M floats (1M with --quick) against the std:: algorithm over the same NamedTemplate. Sum &
+//min / max are where the lanes matter: std::accumulate has to add in order & doesn't vectorize without -ffast-math.
+static void bulkBenchmarks(Benchmark& bench) {
+    const int n = bench.options().quick ? 1000000 : 10000000;
+    vector<float> data(n);
+    RNG rng(7);
+    for (float& v : data) {
+        v = (float)rng.uniform(0, 1000);
+    }
+    const NamedTemplate<float> values(data);
+    NamedTemplate<float> out{vector<float>(n)};
+    const string params = to_string(n);
+    float result = 0;
+
+    bench.run("stl.bulk.fill.std", params, "elements", n, [&]{ std::fill(out.begin(), out.end(), 1.5f); });
+    bench.run("stl.bulk.fill", params, "elements", n, [&]{ bulk::fill(out, 1.5f); });
+    const auto scale = [](float v) { return 0.5f*v + 1.0f; };
+    bench.run("stl.bulk.transform.std", params, "elements", n, [&]{ std::transform(values.begin(), values.end(), out.begin(), scale); });
+    bench.run("stl.bulk.transform", params, "elements", n, [&]{ bulk::transform(values, out, scale); });
+    bench.run("stl.bulk.sum.std", params, "elements", n, [&]{ result += std::accumulate(values.begin(), values.end(), 0.0f); });
+    bench.run("stl.bulk.sum", params, "elements", n, [&]{ result += bulk::sum(values); });
+    bench.run("stl.bulk.minmax.std", params, "elements", n, [&]{
+        const auto range = std::minmax_element(values.begin(), values.end());
+        result += *range.first + *range.second;
+    });
+    bench.run("stl.bulk.minmax", params, "elements", n, [&]{
+        const auto range = bulk::minMax(values);
+        result += range.first + range.second;
+    });
+    //keeps the results alive.
+    if (result == 42.0f) {
+        cout << result << endl;
+    }
+}
+
+//a frame's worth of short lists (10k lists of 0 to 15 ints, like keypoints per grid cell): a std::vector each, the
+//same in a FrameArena that is reset every frame, and SmallVecs that keep up to 16 inline.
+static void allocationBenchmarks(Benchmark& bench) {
+    const int numLists = 10000;
+    const string params = to_string(numLists) + " lists";
+    const double items = numLists;
+    long long sum = 0;
+    auto fill = [&](auto& list, int i) {
+        for (int k = 0; k < i % 16; ++k) {
+            list.push_back(k);
+        }
+        sum += list.size();
+    };
+
+    bench.run("stl.lists.vector", params, "lists", items, [&]{
+        vector<vector<int>> lists(numLists);
+        for (int i = 0; i < numLists; ++i) {
+            fill(lists[i], i);
+        }
+    });
+    FrameArena arena;
+    bench.run("stl.lists.arena", params, "lists", items, [&]{
+        arena.reset();
+        //emplaced, not copies of one list: a copy of a pmr container goes back to the default resource.
+        vector<PmrTempVec<int>> lists;
+        lists.reserve(numLists);
+        for (int i = 0; i < numLists; ++i) {
+            fill(lists.emplace_back(&arena).vector(), i);
+        }
+    });
+    bench.run("stl.lists.SmallVec", params, "lists", items, [&]{
+        vector<SmallVec<int, 16>> lists(numLists);
+        for (int i = 0; i < numLists; ++i) {
+            fill(lists[i], i);
+        }
+    });
+
+    //wrapping a 1M element vector: copied vs moved in (& back out for the next run).
+    vector<int> data(1 << 20, 1);
+    const string size = to_string(data.size());
+    bench.run("stl.TempVec.construct.copy", size, "elements", data.size(), [&]{ TempVec<int> wrapped(data); sum += wrapped.vector().size(); });
+    bench.run("stl.TempVec.construct.move", size, "elements", data.size(), [&]{
+        TempVec<int> wrapped(std::move(data));
+        sum += wrapped.vector().size();
+        data = std::move(wrapped.vector());
+    });
+
+    if (sum == 42) {
+        cout << sum << endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    Benchmark bench(Benchmark::parseArgs(argc, argv));
+    const std::string& tracePath = bench.options().trace;
+    if (!tracePath.empty()) {
+#ifndef SLAM_TRACE
+        cerr << "built without -DSLAM_TRACE, the trace will be empty" << endl;
+#endif
+        Trace::setEnabled(true);
+    }
+
+    rotationBenchmarks(bench);
+    largeRotationBenchmarks(bench);
+    transformBenchmarks(bench);
+    matViewBenchmarks(bench);
+    pyramidBenchmarks(bench);
+    containerBenchmarks(bench);
+    iteratorBenchmarks(bench);
+    bulkBenchmarks(bench);
+    allocationBenchmarks(bench);
+
+    if (!tracePath.empty()) {
+        Trace::setEnabled(false);
+        if (!Trace::writeChromeTrace(tracePath)) {
+            cerr << "couldn't write " << tracePath << endl;
+            return 1;
+        }
+        cout << Trace::summary();
+        cout << "wrote the trace to " << tracePath << endl;
+    }
+
+    if (!bench.options().json.empty()) {
+        if (!bench.writeJson(bench.options().json)) {
+            cerr << "couldn't write " << bench.options().json << endl;
+            return 1;
+        }
+        cout << "wrote " << bench.results().size() << " results to " << bench.options().json << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include <execution>
+#include <numeric>
+#include <thread>
+#include "Benchmark.hpp"
+#include "../WorkingwithSTL/template_containers.hpp"
+#if __has_include(<tbb/global_control.h>)
+#include <tbb/global_control.h>
+#define HAVE_TBB_GLOBAL_CONTROL 1
+#endif
+
+using namespace std;
+
+/*
+    The C++17 parallel algorithms (std::execution::seq / par / par_unseq) on the STL tutorial containers: sort, transform,
+    reduce & fill over large float arrays (10M, 1M with --quick), from 1 thread up to every core. Checks first that
+    every policy gives the serial result on both containers.
+
+    A separate program from benchmark_suite since it needs a parallel STL backend. With GCC's libstdc++ that's TBB:
+    build (from the repo root):
+        g++ -O3 -std=c++17 -march=native Benchmarks/Benchmark.cpp Benchmarks/parallel_algorithms.cpp \
+            `pkg-config --cflags --libs opencv4` -ltbb -pthread -o parallel_algorithms
+    run:
+        ./parallel_algorithms --json parallel.json
+    The thread counts need tbb::global_control, without it every run uses the backend's default.
+*/
+
+//what the parallel policies need: forward iterators at least, and random access ones to actually be split up
+//(libstdc++ runs anything weaker serially).
+template<typename It>
+constexpr bool splittable = std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category>;
+static_assert(splittable<TempVec<float>::Iterator> && splittable<TempVec<float>::ConstIterator>, "TempVec can't be split up");
+static_assert(splittable<decltype(std::declval<NamedTemplate<float>&>().begin())>, "NamedTemplate can't be split up");
+
+static const char* policyName(const std::execution::sequenced_policy&) { return "seq"; }
+static const char* policyName(const std::execution::parallel_policy&) { return "par"; }
+static const char* policyName(const std::execution::parallel_unsequenced_policy&) { return "par_unseq"; }
+
+//every algorithm on one container & policy against the serial std:: versions, exactly: the transform is exact per
+//element, and reduce sums integers in double, exact whatever order the adds happen in.
+template<typename Container, typename Policy>
+static bool validate(const Policy& policy, Container& container, const vector<float>& data, const char* name) {
+    const auto square = [](float v) { return v*v; };
+    bool ok = true;
+    auto check = [&](bool passed, const char* what) {
+        if (!passed) {
+            cerr << name << " " << policyName(policy) << ": " << what << " differs from the serial result" << endl;
+            ok = false;
+        }
+    };
+
+    vector<float> expected = data;
+    std::sort(expected.begin(), expected.end());
+    std::copy(data.begin(), data.end(), container.begin());
+    std::sort(policy, container.begin(), container.end());
+    check(std::equal(container.begin(), container.end(), expected.begin(), expected.end()), "sort");
+
+    std::transform(data.begin(), data.end(), expected.begin(), square);
+    std::copy(data.begin(), data.end(), container.begin());
+    std::transform(policy, container.begin(), container.end(), container.begin(), square);
+    check(std::equal(container.begin(), container.end(), expected.begin(), expected.end()), "transform");
+
+    std::copy(data.begin(), data.end(), container.begin());
+    check(std::reduce(policy, container.begin(), container.end(), 0.0) == std::accumulate(data.begin(), data.end(), 0.0), "reduce");
+
+    std::fill(policy, container.begin(), container.end(), 3.0f);
+    check(std::all_of(container.begin(), container.end(), [](float v) { return v == 3.0f; }), "fill");
+    return ok;
+}
+
+template<typename Container>
+static bool validateAll(Container& container, const vector<float>& data, const char* name) {
+    const bool seq = validate(std::execution::seq, container, data, name);
+    const bool par = validate(std::execution::par, container, data, name);
+    const bool unseq = validate(std::execution::par_unseq, container, data, name);
+    return seq && par && unseq;
+}
+
+template<typename Container, typename Policy>
+static void policyBenchmarks(Benchmark& bench, const Policy& policy, Container& container, const vector<float>& data, const string& prefix, const string& params) {
+    const double n = double(data.size());
+    const string name = prefix + "." + policyName(policy);
+    float sum = 0;
+    //the sort includes copying the unsorted data back in.
+    bench.run(name + ".sort", params, "elements", n, [&]{
+        std::copy(data.begin(), data.end(), container.begin());
+        std::sort(policy, container.begin(), container.end());
+    });
+    bench.run(name + ".transform", params, "elements", n, [&]{
+        std::transform(policy, data.begin(), data.end(), container.begin(), [](float v) { return 0.5f*v + 1.0f; });
+    });
+    bench.run(name + ".reduce", params, "elements", n, [&]{ sum += std::reduce(policy, container.begin(), container.end(), 0.0f); });
+    bench.run(name + ".fill", params, "elements", n, [&]{ std::fill(policy, container.begin(), container.end(), 7.0f); });
+    //keeps the sums alive.
+    if (sum == 42.0f) {
+        cout << sum << endl;
+    }
+}
+
+//1, 2, 4, ... up to & including every core.
+static vector<int> threadCounts() {
+    const int cores = std::max(1, int(std::thread::hardware_concurrency()));
+    vector<int> counts;
+    for (int t = 1; t < cores; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(cores);
+    return counts;
+}
+
+//seq once as the baseline, then par & par_unseq from 1 thread up to every core, so each container gets its own speedups.
+template<typename Container>
+static void containerBenchmarks(Benchmark& bench, Container& container, const vector<float>& data, const string& prefix) {
+    const string size = to_string(data.size());
+    policyBenchmarks(bench, std::execution::seq, container, data, prefix, size);
+    for (int threads : threadCounts()) {
+#ifdef HAVE_TBB_GLOBAL_CONTROL
+        tbb::global_control limit(tbb::global_control::max_allowed_parallelism, threads);
+        const string params = size + "/" + to_string(threads) + "t";
+#else
+        if (threads != threadCounts().back()) {
+            continue;
+        }
+        const string params = size;
+#endif
+        policyBenchmarks(bench, std::execution::par, container, data, prefix, params);
+        policyBenchmarks(bench, std::execution::par_unseq, container, data, prefix, params);
+    }
+}
+
+int main(int argc, char** argv) {
+    Benchmark bench(Benchmark::parseArgs(argc, argv));
+    const int n = bench.options().quick ? 1000000 : 10000000;
+
+    vector<float> data(n);
+    RNG rng(5);
+    for (float& v : data) {
+        v = (float)rng.uniform(0, 1000);
+    }
+    NamedTemplate<float> named(data);
+    vector<float> copy = data;
+    TempVec<float> tempVec(copy);
+
+    const vector<float> small(data.begin(), data.begin() + std::min(n, 100000));
+    NamedTemplate<float> namedSmall(small);
+    vector<float> smallCopy = small;
+    TempVec<float> tempVecSmall(smallCopy);
+    if (!validateAll(namedSmall, small, "NamedTemplate") || !validateAll(tempVecSmall, small, "TempVec")) {
+        return 1;
+    }
+    cout << "seq, par & par_unseq match the serial algorithms on NamedTemplate & TempVec" << endl;
+
+    containerBenchmarks(bench, named, data, "NamedTemplate");
+    containerBenchmarks(bench, tempVec, data, "TempVec");
+
+    if (!bench.options().json.empty()) {
+        if (!bench.writeJson(bench.options().json)) {
+            cerr << "couldn't write " << bench.options().json << endl;
+            return 1;
+        }
+        cout << "wrote " << bench.results().size() << " results to " << bench.options().json << endl;
+    }
+    return 0;
+}
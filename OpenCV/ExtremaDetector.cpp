@@ -0,0 +1,238 @@
+#include "ExtremaDetector.hpp"
+#include "matview.h"
+
+void KeypointArray::clear() {
+    this->x.clear();
+    this->y.clear();
+    this->octave.clear();
+    this->level.clear();
+    this->sigma.clear();
+    this->response.clear();
+}
+
+void KeypointArray::push_back(float px, float py, int oct, int lvl, float sig, float resp) {
+    this->x.push_back(px);
+    this->y.push_back(py);
+    this->octave.push_back(oct);
+    this->level.push_back(lvl);
+    this->sigma.push_back(sig);
+    this->response.push_back(resp);
+}
+
+void KeypointArray::append(const KeypointArray& other) {
+    this->x.insert(this->x.end(), other.x.begin(), other.x.end());
+    this->y.insert(this->y.end(), other.y.begin(), other.y.end());
+    this->octave.insert(this->octave.end(), other.octave.begin(), other.octave.end());
+    this->level.insert(this->level.end(), other.level.begin(), other.level.end());
+    this->sigma.insert(this->sigma.end(), other.sigma.begin(), other.sigma.end());
+    this->response.insert(this->response.end(), other.response.begin(), other.response.end());
+}
+
+
+//a pixel is a candidate if it is above the threshold and strictly above (or below) all 26 neighbours in scale space.
+void ExtremaDetector::findCandidates(const Mat& prev, const Mat& cur, const Mat& next, Range rows, int border, float threshold, std::vector<Point>& candidates) {
+    const int xend = cur.cols - border;
+    for (int y = rows.start; y < rows.end; ++y) {
+        //the 9 rows around (y) in the 3 levels. index 4 is the center row itself.
+        const float* r[9] = {
+            prev.ptr<float>(y-1), prev.ptr<float>(y), prev.ptr<float>(y+1),
+            cur.ptr<float>(y-1),  cur.ptr<float>(y),  cur.ptr<float>(y+1),
+            next.ptr<float>(y-1), next.ptr<float>(y), next.ptr<float>(y+1)
+        };
+        const float* c = r[4];
+        int x = border;
+
+#if CV_SIMD
+        const int lanes = v_float32::nlanes;
+        const v_float32 vthr = vx_setall_f32(threshold);
+        const v_float32 vnthr = vx_setall_f32(-threshold);
+        for (; x <= xend - lanes; x += lanes) {
+            v_float32 val = vx_load(c + x);
+            v_float32 above = val > vthr;
+            v_float32 below = val < vnthr;
+            //most of a DoG image is flat, so skip those pixels before loading the neighbours.
+            if (!v_check_any(above | below)) {
+                continue;
+            }
+
+            v_float32 nmax = vx_load(c + x - 1);
+            v_float32 nmin = nmax;
+            v_float32 n = vx_load(c + x + 1);
+            nmax = v_max(nmax, n);
+            nmin = v_min(nmin, n);
+            for (int i = 0; i < 9; ++i) {
+                if (i == 4) {
+                    continue;
+                }
+                for (int dx = -1; dx <= 1; ++dx) {
+                    n = vx_load(r[i] + x + dx);
+                    nmax = v_max(nmax, n);
+                    nmin = v_min(nmin, n);
+                }
+            }
+
+            int mask = v_signmask((above & (val > nmax)) | (below & (val < nmin)));
+            for (int i = 0; mask != 0; ++i, mask >>= 1) {
+                if (mask & 1) {
+                    candidates.emplace_back(x + i, y);
+                }
+            }
+        }
+#endif
+        for (; x < xend; ++x) {
+            const float val = c[x];
+            if (std::abs(val) <= threshold) {
+                continue;
+            }
+            bool isMax = val > 0;
+            bool isExtremum = true;
+            for (int i = 0; i < 9 && isExtremum; ++i) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (i == 4 && dx == 0) {
+                        continue;
+                    }
+                    float n = r[i][x + dx];
+                    if (isMax ? !(val > n) : !(val < n)) {
+                        isExtremum = false;
+                        break;
+                    }
+                }
+            }
+            if (isExtremum) {
+                candidates.emplace_back(x, y);
+            }
+        }
+    }
+}
+
+//fit a 3D quadratic to the DoG around the candidate & move to the neighbouring sample until the offset is below 0.5
+//in every dimension (section 4 of the SIFT paper, same scheme as OpenCV's adjustLocalExtrema).
+bool ExtremaDetector::refine(const std::vector<Mat>& dogs, const ScaleSpace& scales, const ExtremaOptions& options, int octave, int level, Point pt, KeypointArray& keypoints) {
+    const int numScales = scales.numScales();
+    const int border = options.border;
+    int x = pt.x;
+    int y = pt.y;
+    float xc = 0, xr = 0, xi = 0;
+    float dxx = 0, dyy = 0, dxy = 0;
+    Vec3f dD;
+
+    int step = 0;
+    for (; step < options.maxRefineSteps; ++step) {
+        const SLAM::MatView<const float> img(dogs[level]);
+        const SLAM::MatView<const float> prev(dogs[level-1]);
+        const SLAM::MatView<const float> next(dogs[level+1]);
+
+        dD = Vec3f((img(y, x+1) - img(y, x-1))*0.5f,
+                   (img(y+1, x) - img(y-1, x))*0.5f,
+                   (next(y, x) - prev(y, x))*0.5f);
+
+        float v2 = img(y, x)*2;
+        dxx = img(y, x+1) + img(y, x-1) - v2;
+        dyy = img(y+1, x) + img(y-1, x) - v2;
+        float dss = next(y, x) + prev(y, x) - v2;
+        dxy = (img(y+1, x+1) - img(y+1, x-1) - img(y-1, x+1) + img(y-1, x-1))*0.25f;
+        float dxs = (next(y, x+1) - next(y, x-1) - prev(y, x+1) + prev(y, x-1))*0.25f;
+        float dys = (next(y+1, x) - next(y-1, x) - prev(y+1, x) + prev(y-1, x))*0.25f;
+
+        Matx33f H(dxx, dxy, dxs,
+                  dxy, dyy, dys,
+                  dxs, dys, dss);
+        Vec3f X = H.solve(dD, DECOMP_LU);
+        xc = -X[0];
+        xr = -X[1];
+        xi = -X[2];
+
+        if (std::abs(xi) < 0.5f && std::abs(xr) < 0.5f && std::abs(xc) < 0.5f) {
+            break;
+        }
+        //a (near) singular hessian sends the offset flying.
+        if (std::abs(xi) > float(INT_MAX/3) || std::abs(xr) > float(INT_MAX/3) || std::abs(xc) > float(INT_MAX/3)) {
+            return false;
+        }
+
+        x += cvRound(xc);
+        y += cvRound(xr);
+        level += cvRound(xi);
+        if (level < 1 || level > numScales || x < border || x >= img.cols() - border || y < border || y >= img.rows() - border) {
+            return false;
+        }
+    }
+    if (step >= options.maxRefineSteps) {
+        return false;
+    }
+
+    //reject low contrast: the interpolated value D(x^) = D + 0.5 * dD.x^
+    float contrast = SLAM::MatView<const float>(dogs[level])(y, x) + 0.5f*(dD[0]*xc + dD[1]*xr + dD[2]*xi);
+    if (std::abs(contrast)*numScales < options.contrastThreshold) {
+        return false;
+    }
+
+    //reject edges: tr(H)^2 / det(H) of the spatial hessian has to be below (r+1)^2 / r
+    float tr = dxx + dyy;
+    float det = dxx*dyy - dxy*dxy;
+    float r = options.edgeThreshold;
+    if (det <= 0 || tr*tr*r >= (r + 1)*(r + 1)*det) {
+        return false;
+    }
+
+    //octave 0 is the input upsampled by 2, so 1 octave pixel = 2^octave / 2 input pixels.
+    const float scale = std::ldexp(0.5f, octave);
+    keypoints.push_back((x + xc)*scale, (y + xr)*scale, octave, level,
+                        scales.sigma()*std::pow(2.0f, (level + xi)/numScales)*scale, std::abs(contrast));
+    return true;
+}
+
+void ExtremaDetector::detectTile(const std::vector<Mat>& dogs, const ScaleSpace& scales, const ExtremaOptions& options, int octave, int level, Range rows, KeypointArray& keypoints) {
+    //same pre-threshold as OpenCV, half of the final contrast threshold.
+    const float threshold = 0.5f*options.contrastThreshold/scales.numScales();
+    std::vector<Point> candidates;
+    findCandidates(dogs[level-1], dogs[level], dogs[level+1], rows, options.border, threshold, candidates);
+    for (const Point& pt : candidates) {
+        refine(dogs, scales, options, octave, level, pt, keypoints);
+    }
+}
+
+//extrema are searched in DoG levels 1..numScales, which have a level on either side.
+void ExtremaDetector::detect(const std::vector<std::vector<Mat>>& diffs, const ScaleSpace& scales, KeypointArray& keypoints, const ExtremaOptions& options) {
+    CV_Assert(options.border >= 1);
+    const int tileRows = 64;
+
+    struct Tile { int octave; int level; Range rows; };
+    std::vector<Tile> tiles;
+    for (int o = 0; o < (int)diffs.size(); ++o) {
+        const int rows = diffs[o][0].rows;
+        const int cols = diffs[o][0].cols;
+        if (rows <= 2*options.border || cols <= 2*options.border) {
+            continue;
+        }
+        for (int l = 1; l <= scales.numScales(); ++l) {
+            for (int y = options.border; y < rows - options.border; y += tileRows) {
+                tiles.push_back(Tile{o, l, Range(y, std::min(y + tileRows, rows - options.border))});
+            }
+        }
+    }
+
+    //every tile fills its own list, merged in tile order so the output doesn't depend on the thread count.
+    std::vector<KeypointArray> found(tiles.size());
+    auto runTile = [&](int i) {
+        detectTile(diffs[tiles[i].octave], scales, options, tiles[i].octave, tiles[i].level, tiles[i].rows, found[i]);
+    };
+
+    if (options.numThreads == 1) {
+        for (int i = 0; i < (int)tiles.size(); ++i) {
+            runTile(i);
+        }
+    }
+    else {
+        TaskGraph graph;
+        for (int i = 0; i < (int)tiles.size(); ++i) {
+            graph.add([&runTile, i]{ runTile(i); });
+        }
+        graph.run(TaskScheduler::get(options.numThreads));
+    }
+
+    keypoints.clear();
+    for (const KeypointArray& tile : found) {
+        keypoints.append(tile);
+    }
+}
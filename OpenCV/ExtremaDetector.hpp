@@ -0,0 +1,44 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <vector>
+#include <cmath>
+#include "ScaleSpace.hpp"
+#include "TaskScheduler.hpp"
+
+using namespace cv;
+
+//keypoints as a structure of arrays, one entry per keypoint in every array.
+//x, y & sigma are in input image pixels, octave & level say which DoG image the keypoint was found in.
+struct KeypointArray
+{
+    std::vector<float> x, y;
+    std::vector<int> octave, level;
+    std::vector<float> sigma, response;
+    size_t size() const { return this->x.size(); }
+    void clear();
+    void push_back(float px, float py, int oct, int lvl, float sig, float resp);
+    void append(const KeypointArray& other);
+};
+
+struct ExtremaOptions
+{
+    float contrastThreshold = 0.04f;    //for a [0,1] image, divided by the number of scales like OpenCV's SIFT does.
+    float edgeThreshold = 10.0f;        //max ratio of principal curvatures, r in the SIFT paper.
+    int maxRefineSteps = 5;
+    int border = 5;                     //pixels skipped along the border of every octave.
+    int numThreads = 1;                 //same meaning as PyramidOptions::numThreads
+};
+
+//Finds the 3x3x3 extrema of a DoG pyramid, refines them with the quadratic fit of the SIFT paper (section 4)
+//and rejects low contrast & edge responses.
+//The scan is vectorized, and the pyramid is split into (octave, level, row band) tiles which run in parallel.
+class ExtremaDetector
+{
+    public:
+        static void detect(const std::vector<std::vector<Mat>>& diffs, const ScaleSpace& scales, KeypointArray& keypoints, const ExtremaOptions& options = ExtremaOptions());
+    private:
+        static void detectTile(const std::vector<Mat>& dogs, const ScaleSpace& scales, const ExtremaOptions& options, int octave, int level, Range rows, KeypointArray& keypoints);
+        static void findCandidates(const Mat& prev, const Mat& cur, const Mat& next, Range rows, int border, float threshold, std::vector<Point>& candidates);
+        static bool refine(const std::vector<Mat>& dogs, const ScaleSpace& scales, const ExtremaOptions& options, int octave, int level, Point pt, KeypointArray& keypoints);
+};
@@ -32,14 +32,15 @@ using std::cout, std::endl;
 //new_sigma = sqrt( sig1**2 + sig2**2 )
 //this will probably be the fastest method.
 //https://math.stackexchange.com/questions/3159846/what-is-the-resulting-sigma-after-applying-successive-gaussian-blur
-//for development sake though, it will just be fastest to blur each previous image.
+//this is what ScaleSpace does: every level is blurred from the previous one with the incremental sigma
+//sqrt( (sigma*k^i)**2 - (sigma*k^(i-1))**2 ), so level i ends up at sigma*k^i with the smallest kernel possible.
 
 
-void GaussPyramid::displayPyramid(const std::map<int, std::vector<Mat>> pyramid) {
+void GaussPyramid::displayPyramid(const std::vector<std::vector<Mat>>& pyramid) {
     std::string window_name;
-    for (const auto& kv: pyramid) {
-        window_name = "Octave " + std::to_string(kv.first) + " blur";
-        GaussPyramid::showOctave(kv.second, window_name, Point(kv.second.at(0).cols, 0));
+    for (int i = 0; i < (int)pyramid.size(); ++i) {
+        window_name = "Octave " + std::to_string(i) + " blur";
+        GaussPyramid::showOctave(pyramid[i], window_name, Point(pyramid[i].at(0).cols, 0));
     }
 }
 
@@ -56,54 +57,431 @@ void GaussPyramid::showOctave(const std::vector<Mat> images, const std::string w
 }
 
 void GaussPyramid::createPyramid(Mat& img) {
+    TRACE_SCOPE("pyramid.frame");
     //the sift paper states they double the size of the original image for the first level of the pyramid.
     //'double the size of the input image using linear interpolation prior to building the first level of the pyramid'
-    Mat pyrBase;
-    resize(img, pyrBase, Size(), 2, 2, INTER_LINEAR);
+    //work on a grayscale float image in [0,1], otherwise the differences of gaussians can't go negative.
+    {
+        TRACE_SCOPE("pyramid.convert", uint64_t(img.total())*(img.elemSize() + sizeof(float)));
+        const Mat& gray = grayInput(img, this->gray_);
+        gray.convertTo(this->input_, CV_32F, gray.depth() == CV_8U ? 1.0/255.0 : 1.0);
+    }
+
+    //every level of every octave lives in one arena, only (re)allocated when the frame size changes.
+    if (this->storage_.reset(Size(2*img.cols, 2*img.rows), this->numOctaves_, this->numImages_, storageType(this->options_.precision))) {
+        this->graph_.reset();
+    }
+    this->builtLevels_.assign(this->numOctaves_, 0);
+    this->builtDiffs_.assign(this->numOctaves_, 0);
+    if (this->options_.lazy) {
+        return;     //see materialize()
+    }
+
+    if (this->options_.numThreads != 1) {
+        createPyramidParallel();
+    }
+    else {
+        upsampleInput();
+        createPyramidSerial();
+    }
+    this->builtLevels_.assign(this->numOctaves_, this->numImages_);
+    this->builtDiffs_.assign(this->numOctaves_, this->numImages_ - 1);
+}
+
+const Mat& GaussPyramid::grayInput(const Mat& img, Mat& buffer) {
+    switch (img.channels()) {
+        case 1: return img;
+        case 3: cvtColor(img, buffer, COLOR_BGR2GRAY); return buffer;
+        case 4: cvtColor(img, buffer, COLOR_BGRA2GRAY); return buffer;
+        default: CV_Error(Error::StsBadArg, "GaussPyramid takes 1 (gray), 3 (BGR) or 4 (BGRA) channel images");
+    }
+}
+
+int GaussPyramid::storageType(PyramidPrecision precision) {
+    switch (precision) {
+        case PyramidPrecision::Float16: return CV_16FC1;
+        case PyramidPrecision::Fixed16: return CV_16SC1;
+        default: return CV_32FC1;
+    }
+}
+
+void GaussPyramid::upsampleInput() {
+    Mat& base = this->storage_.base();
+    upsampleRegion(this->input_, Point(0, 0), this->input_.size(), base, Point(0, 0), Rect(0, 0, base.cols, base.rows), valueScale());
+}
+
+static inline void storeValue(float v, double, float& dst) { dst = v; }
+static inline void storeValue(float v, double, cv::float16_t& dst) { dst = cv::float16_t(v); }
+static inline void storeValue(float v, double scale, short& dst) { dst = saturate_cast<short>(v*float(scale)); }
 
+//the 2x bilinear upsampling of resize(INTER_LINEAR) with edges clamped, which at exactly 2x comes down to weights of
+//0.75 & 0.25: an even output pixel 2i mixes input i with i-1, an odd one 2i+1 mixes i with i+1.
+//every output pixel is computed on its own in float & only rounded when stored, so any rect comes out the same as in a full image.
+template<typename T>
+static void upsampleRegionT(const Mat& input, Point inputOrigin, Size inputSize, Mat& dst, Point dstOrigin, Rect rect, double scale) {
+    AutoBuffer<int> near(rect.width), far(rect.width);
+    for (int x = 0; x < rect.width; ++x) {
+        const int X = rect.x + x;
+        const int i = X >> 1;
+        near[x] = i - inputOrigin.x;
+        far[x] = std::min(std::max((X & 1) ? i + 1 : i - 1, 0), inputSize.width - 1) - inputOrigin.x;
+    }
+    for (int Y = rect.y; Y < rect.y + rect.height; ++Y) {
+        const int i = Y >> 1;
+        const float* a = input.ptr<float>(i - inputOrigin.y);
+        const float* b = input.ptr<float>(std::min(std::max((Y & 1) ? i + 1 : i - 1, 0), inputSize.height - 1) - inputOrigin.y);
+        T* dstRow = dst.ptr<T>(Y - dstOrigin.y) + (rect.x - dstOrigin.x);
+        for (int x = 0; x < rect.width; ++x) {
+            const float ha = 0.75f*a[near[x]] + 0.25f*a[far[x]];
+            const float hb = 0.75f*b[near[x]] + 0.25f*b[far[x]];
+            storeValue(0.75f*ha + 0.25f*hb, scale, dstRow[x]);
+        }
+    }
+}
+
+//the input is always float, the 16 bit modes round each upsampled pixel once into the base.
+void GaussPyramid::upsampleRegion(const Mat& input, Point inputOrigin, Size inputSize, Mat& dst, Point dstOrigin, Rect rect, double scale) {
+    CV_Assert(input.type() == CV_32FC1);
+    TRACE_SCOPE("pyramid.upsample", uint64_t(rect.area())*(dst.elemSize() + sizeof(float)/4));
+    switch (dst.depth()) {
+        case CV_32F: upsampleRegionT<float>(input, inputOrigin, inputSize, dst, dstOrigin, rect, scale); break;
+        case CV_16F: upsampleRegionT<cv::float16_t>(input, inputOrigin, inputSize, dst, dstOrigin, rect, scale); break;
+        case CV_16S: upsampleRegionT<short>(input, inputOrigin, inputSize, dst, dstOrigin, rect, scale); break;
+        default: CV_Error(Error::StsUnsupportedFormat, "unsupported pyramid type");
+    }
+}
+
+void GaussPyramid::createPyramidSerial() {
     for (int i = 0; i < this->numOctaves_; ++i) {
-        //allocate 7 empty images to move the data over.
-        std::vector<Mat> gaussians = GaussVector(pyrBase);
-        std::vector<Mat> diffs = Diff_of_Gauss(gaussians);
+        std::vector<Mat>& gaussians = this->storage_.blurOctave(i);
+        if (i > 0) {
+            //The SIFT paper states that, they take a gaussian image w/ twice the initial value of sigma, this corresponds to
+            //the 3rd image from the top (in our case, the 5th image) of the previous octave, downsampled to half the size.
+            const Mat& octaveBase = this->storage_.blurOctave(i-1).at(this->numOctaves_);
+            downsampleRows(octaveBase, gaussians[0], 0, gaussians[0].rows);
+        }
+        if (this->options_.fusedDoG) {
+            GaussVector(this->storage_.base(), gaussians, &this->storage_.diffOctave(i), i == 0);
+        }
+        else {
+            GaussVector(this->storage_.base(), gaussians, nullptr, i == 0);
+            Diff_of_Gauss(gaussians, this->storage_.diffOctave(i));
+        }
+    }
+}
+
+const std::vector<Mat>& GaussPyramid::getBlurOctave(int key) {
+    CV_Assert(0 <= key && key < this->numOctaves_);
+    std::lock_guard<std::mutex> guard(this->lazyLock_);
+    materialize(key, this->numImages_, false);
+    return this->storage_.gaussians()[key];
+}
+
+const std::vector<Mat>& GaussPyramid::getDiffOctave(int key) {
+    CV_Assert(0 <= key && key < this->numOctaves_);
+    std::lock_guard<std::mutex> guard(this->lazyLock_);
+    materialize(key, this->numImages_, true);
+    return this->storage_.diffs()[key];
+}
+
+const std::vector<std::vector<Mat>>& GaussPyramid::gaussPyramid() const {
+    CV_Assert(isBuilt(Range(0, this->numOctaves_)));
+    return this->storage_.gaussians();
+}
+
+const std::vector<std::vector<Mat>>& GaussPyramid::diffPyramid() const {
+    CV_Assert(isBuilt(Range(0, this->numOctaves_)));
+    return this->storage_.diffs();
+}
+
+const std::vector<Mat>& GaussPyramid::getBlurOctave(int key) const {
+    CV_Assert(0 <= key && key < this->numOctaves_ && isBuilt(Range(key, key + 1)));
+    return this->storage_.gaussians()[key];
+}
 
-        //The SIFT paper states that, they take a gaussian image w/ twice the initial value of sigma, this corresponds to
-        //the 3rd image from the top (in our case, the 5th image)
-        Mat octaveBase = gaussians.at(this->numOctaves_); //only copies the header
+const std::vector<Mat>& GaussPyramid::getDiffOctave(int key) const {
+    CV_Assert(0 <= key && key < this->numOctaves_ && isBuilt(Range(key, key + 1)));
+    return this->storage_.diffs()[key];
+}
 
-        //now with the resized image, repeat the two for the other levels of the pyramid.
-        resize(octaveBase, pyrBase, Size(), 0.5, 0.5, INTER_NEAREST);
-        
-        this->gauss_pyramid.emplace(i, gaussians);
-        this->diff_pyramid.emplace(i, diffs);
+bool GaussPyramid::isBuilt(const Range& octaves) const {
+    for (int o = std::max(0, octaves.start); o < std::min(octaves.end, this->numOctaves_); ++o) {
+        if (this->builtLevels_[o] < this->numImages_ || this->builtDiffs_[o] < this->numImages_ - 1) {
+            return false;
+        }
     }
+    return true;
 }
 
-std::vector<Mat> GaussPyramid::GaussVector(Mat& img) {
-    std::vector<Mat> gaussians{this->numImages_, Mat::zeros(img.size(), CV_32FC1)};
-    Mat blurred;
-    for (int i = 0; i < this->numImages_; ++i) {
-        
-        if (i == 0 ) {
-            GaussianBlur(img, blurred, Size(0,0), this->sigma_*this->k_, 0, BORDER_DEFAULT);
+void GaussPyramid::prefetch(const Range& octaves) {
+    std::lock_guard<std::mutex> guard(this->lazyLock_);
+    for (int o = std::max(0, octaves.start); o < std::min(octaves.end, this->numOctaves_); ++o) {
+        materialize(o, this->numImages_, true);
+    }
+}
+
+//make sure gaussian levels [0, numLevels) of an octave exist, and all of its DoG levels if diffs is set.
+//an octave's base only needs levels 0..numOctaves_ of the octave below, so asking for a coarse octave
+//doesn't build the top levels or the DoGs of the finer ones. A no-op once everything is built.
+void GaussPyramid::materialize(int octave, int numLevels, bool diffs) {
+    int& built = this->builtLevels_[octave];
+    int& builtDiffs = this->builtDiffs_[octave];
+    std::vector<Mat>& gaussians = this->storage_.blurOctave(octave);
+    std::vector<Mat>& dogs = this->storage_.diffOctave(octave);
+
+    if (built == 0) {
+        if (octave == 0) {
+            upsampleInput();
+            this->scales_.blur(this->storage_.base(), gaussians[0], 0);
         }
-        else if(i > 0) {
-            GaussianBlur(gaussians[i-1], blurred, Size(0,0), this->sigma_*this->k_, 0, BORDER_DEFAULT);
+        else {
+            materialize(octave - 1, this->numOctaves_ + 1, false);
+            const Mat& octaveBase = this->storage_.blurOctave(octave - 1)[this->numOctaves_];
+            downsampleRows(octaveBase, gaussians[0], 0, gaussians[0].rows);
+        }
+        built = 1;
+    }
+
+    for (; built < numLevels; ++built) {
+        //fuse the DoG while it's still contiguous with what's already there.
+        const bool fuse = diffs && this->options_.fusedDoG && builtDiffs == built - 1;
+        this->scales_.blurRows(gaussians[built-1], gaussians[built], built, 0, gaussians[built].rows, fuse ? &dogs[built-1] : nullptr);
+        if (fuse) {
+            ++builtDiffs;
+        }
+    }
+
+    if (diffs) {
+        for (; builtDiffs < numLevels - 1; ++builtDiffs) {
+            diffRows(gaussians[builtDiffs+1], gaussians[builtDiffs], dogs[builtDiffs], 0, dogs[builtDiffs].rows);
         }
-        
-        //cv::swap(blurred, gaussians[i]);     //note that swap is just slightly slower (by .1~1 miliseconds)
-        gaussians[i] = std::move(blurred);
-        //each iteration, take the previous blurred image & blur it again.
     }
-    return gaussians;
 }
 
-std::vector<Mat> GaussPyramid::Diff_of_Gauss(std::vector<Mat> gaussians) {
-    //now, get a vector of difference of gaussians.
-    std::vector<Mat> diffs{gaussians.size()-1, Mat::zeros(gaussians[0].size(), CV_32FC1)};
-    for (int i = 1; i < gaussians.size(); i++) {
+template<typename T>
+static void downsampleRegionT(const Mat& src, Point srcOrigin, Mat& dst, Point dstOrigin, Rect rect) {
+    for (int y = rect.y; y < rect.y + rect.height; ++y) {
+        const T* srcRow = src.ptr<T>(2*y - srcOrigin.y) - srcOrigin.x;
+        T* dstRow = dst.ptr<T>(y - dstOrigin.y) - dstOrigin.x;
+        for (int x = rect.x; x < rect.x + rect.width; ++x) {
+            dstRow[x] = srcRow[2*x];
+        }
+    }
+}
+
+//same sampling as resize(src, dst, Size(), 0.5, 0.5, INTER_NEAREST), i.e. dst(y,x) = src(2y,2x), but for a region only.
+//it's a plain copy, so the 16 bit modes are simply moved around as 16 bit words.
+void GaussPyramid::downsampleRegion(const Mat& src, Point srcOrigin, Mat& dst, Point dstOrigin, Rect rect) {
+    //every other source row is read whole, every other pixel of it is used.
+    TRACE_SCOPE("pyramid.downsample", uint64_t(rect.area())*3*src.elemSize());
+    if (src.elemSize() == sizeof(float)) {
+        downsampleRegionT<float>(src, srcOrigin, dst, dstOrigin, rect);
+    }
+    else {
+        downsampleRegionT<ushort>(src, srcOrigin, dst, dstOrigin, rect);
+    }
+}
+
+void GaussPyramid::downsampleRows(const Mat& src, Mat& dst, int y0, int y1) {
+    downsampleRegion(src, Point(0, 0), dst, Point(0, 0), Rect(0, y0, dst.cols, y1 - y0));
+}
+
+void GaussPyramid::diffRows(const Mat& hi, const Mat& lo, Mat& dst, int y0, int y1) {
+    TRACE_SCOPE("pyramid.dog", uint64_t(y1 - y0)*dst.cols*3*dst.elemSize());
+    for (int y = y0; y < y1; ++y) {
+        switch (dst.depth()) {
+            case CV_32F: ScaleSpace::diffRow(hi.ptr<float>(y), lo.ptr<float>(y), dst.ptr<float>(y), dst.cols); break;
+            case CV_16F: ScaleSpace::diffRow(hi.ptr<cv::float16_t>(y), lo.ptr<cv::float16_t>(y), dst.ptr<cv::float16_t>(y), dst.cols); break;
+            case CV_16S: ScaleSpace::diffRow(hi.ptr<short>(y), lo.ptr<short>(y), dst.ptr<short>(y), dst.cols); break;
+        }
+    }
+}
+
+void GaussPyramid::detectExtrema(KeypointArray& keypoints, const ExtremaOptions& options) {
+    const std::vector<std::vector<Mat>>& diffs = diffPyramid();
+    TRACE_SCOPE("pyramid.detectExtrema");
+    if (this->options_.precision == PyramidPrecision::Float32) {
+        ExtremaDetector::detect(diffs, this->scales_, keypoints, options);
+        return;
+    }
+    this->floatDiffs_.resize(diffs.size());
+    for (int o = 0; o < (int)diffs.size(); ++o) {
+        this->floatDiffs_[o].resize(diffs[o].size());
+        for (int l = 0; l < (int)diffs[o].size(); ++l) {
+            diffs[o][l].convertTo(this->floatDiffs_[o][l], CV_32F, 1.0/valueScale());
+        }
+    }
+    ExtremaDetector::detect(this->floatDiffs_, this->scales_, keypoints, options);
+}
+
+//the blur kernels are non-negative & sum to 1, so an error already in a level never grows through the blurs,
+//each blur only adds its own. With e_l the error a blur of level l adds:
+//  octave 0:  E(0,l) = e_input + e_0 + ... + e_l
+//  octave o:  E(o,l) = E(o-1, numScales) + e_1 + ... + e_l        (the downsampling is exact)
+//Float16: every stored level is rounded once, and a value in [0,1] is off by at most half an ulp of 0.5..1, 2^-12.
+//Fixed16: both passes round to Q14 (2 * 0.5 LSB), plus the quantization error of the kernel in both directions.
+//the float pyramid's own rounding (~1e-7 per level) is ignored.
+float GaussPyramid::levelErrorBound(int octave, int level) const {
+    CV_Assert(0 <= octave && octave < this->numOctaves_ && 0 <= level && level < this->numImages_);
+    const float lsb = 1.0f/ScaleSpace::fixedOne;
+    auto blurError = [&](int l) {
+        switch (this->options_.precision) {
+            case PyramidPrecision::Float16: return std::ldexp(1.0f, -12);
+            case PyramidPrecision::Fixed16: return lsb + 2*this->scales_.fixedKernelError(l);
+            default: return 0.0f;
+        }
+    };
+
+    float error = 0.0f;
+    if (octave == 0) {
+        //the upsampled input is rounded once, to Q14 or to half.
+        error = this->options_.precision == PyramidPrecision::Fixed16 ? 0.5f*lsb : blurError(0);
+        error += blurError(0);
+    }
+    else {
+        error = levelErrorBound(octave - 1, this->numOctaves_);
+    }
+    for (int l = 1; l <= level; ++l) {
+        error += blurError(l);
+    }
+    return error;
+}
+
+//the fixed point difference is exact, the half one is rounded again (DoG values are below 1, so by at most 2^-12).
+float GaussPyramid::diffErrorBound(int octave, int level) const {
+    CV_Assert(0 <= level && level < this->numImages_ - 1);
+    float error = levelErrorBound(octave, level + 1) + levelErrorBound(octave, level);
+    if (this->options_.precision == PyramidPrecision::Float16) {
+        error += std::ldexp(1.0f, -12);
+    }
+    return error;
+}
+
+//split an octave into row bands. the big octaves get ~4 bands per thread so stealing can even out the load,
+//small octaves aren't worth splitting.
+std::vector<Range> GaussPyramid::rowBands(int rows, int numThreads) const {
+    const int minBandRows = 16;
+    int numBands = std::max(1, std::min(4*numThreads, rows/minBandRows));
+    std::vector<Range> bands;
+    for (int b = 0; b < numBands; ++b) {
+        bands.emplace_back(b*rows/numBands, (b + 1)*rows/numBands);
+    }
+    return bands;
+}
+
+//The parallel build runs the same per-row kernels as the serial one, as a task graph over row bands:
+//  - upsample band b of the input, in the bands of octave 0
+//  - blur band b of level l once the bands of level l-1 it reads (band +- kernel radius) are done
+//  - DoG band b of level l as soon as band b of levels l and l+1 are done, no waiting on the rest of the octave.
+//    with fusedDoG it is simply done by the task blurring band b of level l+1.
+//  - downsample band b of the next octave's base once the bands of level numOctaves_ it samples are done,
+//    so the next octave starts while the top levels of the current one are still blurring.
+//The graph only points at the buffers in storage_, so it is built once per layout and re-run for every frame.
+void GaussPyramid::buildTaskGraph() {
+    const int numThreads = TaskScheduler::get(this->options_.numThreads).numThreads();
+    this->graph_ = std::make_unique<TaskGraph>();
+    TaskGraph& graph = *this->graph_;
+
+    //make 'task' wait on every band of 'producers' that overlaps 'needed'.
+    auto dependOn = [&graph](int task, const std::vector<Range>& bands, const std::vector<int>& producers, Range needed) {
+        for (int b = 0; b < (int)bands.size(); ++b) {
+            if (bands[b].start < needed.end && needed.start < bands[b].end) {
+                graph.precede(producers[b], task);
+            }
+        }
+    };
+
+    const ScaleSpace* scales = &this->scales_;
+    std::vector<Range> prevBands;
+    std::vector<int> prevOctaveBase;    //tasks producing level numOctaves_ of the previous octave
+    for (int o = 0; o < this->numOctaves_; ++o) {
+        std::vector<Mat>& gaussians = this->storage_.blurOctave(o);
+        std::vector<Mat>& diffs = this->storage_.diffOctave(o);
+        const int rows = gaussians[0].rows;
+        const std::vector<Range> bands = rowBands(rows, numThreads);
+        std::vector<std::vector<int>> levelTasks(this->numImages_);
+
+        //the upsampled input, in the same bands as octave 0.
+        std::vector<int> baseTasks;
+        if (o == 0) {
+            const Mat* input = &this->input_;
+            Mat* base = &this->storage_.base();
+            const double scale = valueScale();
+            for (const Range& band : bands) {
+                baseTasks.push_back(graph.add([input, base, band, scale]{
+                    upsampleRegion(*input, Point(0, 0), input->size(), *base, Point(0, 0), Rect(0, band.start, base->cols, band.size()), scale);
+                }));
+            }
+        }
+
+        for (int l = 0; l < this->numImages_; ++l) {
+            Mat* dst = &gaussians[l];
+            for (const Range& band : bands) {
+                int task = 0;
+                if (l == 0 && o == 0) {
+                    const Mat* src = &this->storage_.base();
+                    const int r = this->scales_.radius(0);
+                    task = graph.add([scales, src, dst, band]{ scales->blurRows(*src, *dst, 0, band.start, band.end); });
+                    dependOn(task, bands, baseTasks, Range(std::max(0, band.start - r), std::min(rows, band.end + r)));
+                }
+                else if (l == 0) {
+                    const Mat* src = &this->storage_.blurOctave(o-1)[this->numOctaves_];
+                    task = graph.add([src, dst, band]{ downsampleRows(*src, *dst, band.start, band.end); });
+                    dependOn(task, prevBands, prevOctaveBase, Range(2*band.start, 2*band.end - 1));
+                }
+                else {
+                    const Mat* src = &gaussians[l-1];
+                    Mat* diff = this->options_.fusedDoG ? &diffs[l-1] : nullptr;
+                    const int r = this->scales_.radius(l);
+                    task = graph.add([scales, src, dst, diff, l, band]{ scales->blurRows(*src, *dst, l, band.start, band.end, diff); });
+                    dependOn(task, bands, levelTasks[l-1], Range(std::max(0, band.start - r), std::min(rows, band.end + r)));
+                }
+                levelTasks[l].push_back(task);
+            }
+
+            if (l > 0 && !this->options_.fusedDoG) {
+                const Mat* hi = &gaussians[l];
+                const Mat* lo = &gaussians[l-1];
+                Mat* diff = &diffs[l-1];
+                for (int b = 0; b < (int)bands.size(); ++b) {
+                    const Range band = bands[b];
+                    int task = graph.add([hi, lo, diff, band]{ diffRows(*hi, *lo, *diff, band.start, band.end); });
+                    graph.precede(levelTasks[l][b], task);
+                    graph.precede(levelTasks[l-1][b], task);
+                }
+            }
+        }
+        prevBands = bands;
+        prevOctaveBase = levelTasks[this->numOctaves_];
+    }
+}
+
+void GaussPyramid::createPyramidParallel() {
+    if (!this->graph_) {
+        buildTaskGraph();
+    }
+    this->graph_->run(TaskScheduler::get(this->options_.numThreads));
+}
+
+//if diffs is given, the difference of gaussians is fused into the blur: diffs[i-1] is written row by row while level i is blurred.
+void GaussPyramid::GaussVector(const Mat& img, std::vector<Mat>& gaussians, std::vector<Mat>* diffs, bool firstOctave) {
+    //level 0 is the octave base at sigma. Only the upsampled input still needs to be blurred to get there,
+    //the base of every later octave is a downsampled level that is already at sigma (written by createPyramid).
+    if (firstOctave) {
+        this->scales_.blur(img, gaussians[0], 0);
+    }
+
+    for (int i = 1; i < this->numImages_; ++i) {
+        //each iteration, take the previous blurred image & blur it by the incremental sigma of the level.
+        Mat* diff = diffs ? &(*diffs)[i-1] : nullptr;
+        this->scales_.blurRows(gaussians[i-1], gaussians[i], i, 0, gaussians[i].rows, diff);
+    }
+}
+
+void GaussPyramid::Diff_of_Gauss(const std::vector<Mat>& gaussians, std::vector<Mat>& diffs) {
+    //now, get a vector of difference of gaussians, written straight into the preallocated levels.
+    for (int i = 1; i < (int)gaussians.size(); i++) {
         //start i =1, therefore we can always grab the previous gaussian.
-         //moving it mighttt be the problem? Since it's an rvalue in the first place and we're moving to an lvalue?
-        diffs[i-1] = std::move(gaussians[i] - gaussians[i-1]);      
+        diffRows(gaussians[i], gaussians[i-1], diffs[i-1], 0, diffs[i-1].rows);
     }
-    return diffs;
 }
\ No newline at end of file
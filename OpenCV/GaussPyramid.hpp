@@ -6,29 +6,113 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <cmath>
 #include <string>
+#include "ScaleSpace.hpp"
+#include "TaskScheduler.hpp"
+#include "PyramidStorage.hpp"
+#include "ExtremaDetector.hpp"
 
 using namespace cv;
 
+//what the levels of a GaussPyramid are stored as.
+//  Float32: CV_32F.
+//  Float16: CV_16F, blurred with float accumulation & rounded once per stored level. Half the memory traffic & footprint.
+//  Fixed16: CV_16S holding round(v * 2^14) (ScaleSpace::fixedBits), blurred with integer kernels. Same footprint as Float16,
+//           needs no half float support, and is deterministic on any target. The input has to be in [0,1] (8 bit
+//           images are), as values saturate just below 2.
+//The difference to the Float32 pyramid is bounded by GaussPyramid::levelErrorBound() / diffErrorBound(), both in [0,1] units.
+//For 3 scales & sigma 1.6, the DoG bound of the top octave is ~6e-3 for Float16 & ~1.5e-2 for Fixed16 (the kernel
+//quantization term is a loose worst case), while the measured error is around 1e-4..6e-4, against a keypoint contrast
+//threshold of 0.04/3. See pyramid_precision_test.cpp.
+enum class PyramidPrecision { Float32, Float16, Fixed16 };
+
+//how a GaussPyramid gets built.
+struct PyramidOptions
+{
+    //1 builds serially on the calling thread. Anything else runs the build as a task graph on a shared
+    //work-stealing pool with that many threads (0 = one per core). Both give bit-identical pyramids.
+    int numThreads = 1;
+    //compute each DoG level inside the blur of the level above it, row by row, instead of as a separate pass.
+    bool fusedDoG = true;
+    //don't build anything up front: an octave (and the octaves below it that it is downsampled from) is built
+    //the first time it is asked for, and kept until the next rebuild. Lazy octaves are built on the calling thread.
+    bool lazy = false;
+    PyramidPrecision precision = PyramidPrecision::Float32;
+};
+
 class GaussPyramid
 {
     public:
-        GaussPyramid(Mat& img, int numOctaves, float sigma) : numOctaves_{numOctaves}, sigma_{sigma} { createPyramid(img); } 
-        const std::map<int, std::vector<Mat>>& gaussPyramid() { return this->gauss_pyramid; }
-        const std::map<int, std::vector<Mat>>& diffPyramid() { return this->diff_pyramid; }
-        const std::vector<Mat>& getBlurOctave(int key) { return this->gauss_pyramid.at(key); }
-        const std::vector<Mat>& getDiffOctave(int key) { return this->diff_pyramid.at(key); }
-        static void displayPyramid(const std::map<int, std::vector<Mat>> pyramid);
+        GaussPyramid(Mat& img, int numOctaves, float sigma) : GaussPyramid(img, numOctaves, sigma, PyramidOptions()) {}
+        GaussPyramid(Mat& img, int numOctaves, float sigma, const PyramidOptions& options) : numOctaves_{numOctaves}, sigma_{sigma}, scales_{ScaleSpace::get(numOctaves, sigma)}, options_{options} { createPyramid(img); } 
+        GaussPyramid(const GaussPyramid&) = delete;             //the levels are headers into storage_, and the task graph points at them.
+        GaussPyramid& operator=(const GaussPyramid&) = delete;
+        //build the pyramid of a new frame. For a frame of the same size every buffer (and the task graph) is reused.
+        void rebuild(Mat& img) { createPyramid(img); }
+        //note: the levels live in the pyramid's arena, clone() them to keep them past the next rebuild or the pyramid itself.
+        //in lazy mode, these build whatever hasn't been built yet.
+        const std::vector<std::vector<Mat>>& gaussPyramid() { prefetch(Range(0, this->numOctaves_)); return this->storage_.gaussians(); }
+        const std::vector<std::vector<Mat>>& diffPyramid() { prefetch(Range(0, this->numOctaves_)); return this->storage_.diffs(); }
+        const std::vector<Mat>& getBlurOctave(int key);
+        const std::vector<Mat>& getDiffOctave(int key);
+        void prefetch(const Range& octaves);
+        //read only access to levels that are already built: always when not lazy, after prefetch() when lazy.
+        //nothing is built, so several threads can read at once, but a level that's still missing is an error.
+        const std::vector<std::vector<Mat>>& gaussPyramid() const;
+        const std::vector<std::vector<Mat>>& diffPyramid() const;
+        const std::vector<Mat>& getBlurOctave(int key) const;
+        const std::vector<Mat>& getDiffOctave(int key) const;
+        //whether every gaussian & DoG level of octaves is built. Not while a lazy octave is being built on another thread.
+        bool isBuilt(const Range& octaves) const;
+        //scale space extrema of the DoG pyramid, refined & filtered. See ExtremaDetector.
+        //16 bit pyramids are converted to float for the detector, into buffers kept across frames.
+        void detectExtrema(KeypointArray& keypoints, const ExtremaOptions& options = ExtremaOptions());
+        int numOctaves() const { return this->numOctaves_; }
+        const ScaleSpace& scaleSpace() const { return this->scales_; }
+        PyramidPrecision precision() const { return this->options_.precision; }
+        //what one unit of a [0,1] image is stored as: 1 for the float modes, 2^14 for Fixed16.
+        double valueScale() const { return this->options_.precision == PyramidPrecision::Fixed16 ? ScaleSpace::fixedOne : 1.0; }
+        //worst case |level - Float32 level|, in [0,1] units. 0 for Float32.
+        float levelErrorBound(int octave, int level) const;
+        float diffErrorBound(int octave, int level) const;
+        size_t memoryFootprint() const { return this->storage_.capacity(); }
+        //CV_32FC1, CV_16FC1 or CV_16SC1
+        static int storageType(PyramidPrecision precision);
+        //img as a single channel: BGR & BGRA are converted into buffer (reused across frames), gray comes back as is.
+        //any other channel count is rejected, it would reach the arena with the wrong type & reallocate it every frame.
+        static const Mat& grayInput(const Mat& img, Mat& buffer);
+        //the resampling between octaves, for any rect of an octave. src / dst only hold the part of their image starting at the origin.
+        //upsampleRegion: octave 0 from the float [0,1] input (of inputSize), scaled by valueScale(). downsampleRegion: dst(y,x) = src(2y,2x).
+        static void upsampleRegion(const Mat& input, Point inputOrigin, Size inputSize, Mat& dst, Point dstOrigin, Rect rect, double scale);
+        static void downsampleRegion(const Mat& src, Point srcOrigin, Mat& dst, Point dstOrigin, Rect rect);
+        //dst = hi - lo over rows [y0, y1), for any pyramid type.
+        static void diffRows(const Mat& hi, const Mat& lo, Mat& dst, int y0, int y1);
+        static void displayPyramid(const std::vector<std::vector<Mat>>& pyramid);
         static void showOctave(const std::vector<Mat> images, const std::string window_name, const Point pos = Point(0,0));
     private:
         void createPyramid(Mat& img);
-        std::vector<Mat> GaussVector(Mat& img);
-        std::vector<Mat> Diff_of_Gauss(std::vector<Mat> gaussians);
-        std::map<int, std::vector<Mat>> gauss_pyramid;
-        std::map<int, std::vector<Mat>> diff_pyramid;
+        void upsampleInput();
+        void createPyramidSerial();
+        void createPyramidParallel();
+        void buildTaskGraph();
+        void materialize(int octave, int numLevels, bool diffs);
+        std::vector<Range> rowBands(int rows, int numThreads) const;
+        static void downsampleRows(const Mat& src, Mat& dst, int y0, int y1);
+        void GaussVector(const Mat& img, std::vector<Mat>& gaussians, std::vector<Mat>* diffs, bool firstOctave);
+        void Diff_of_Gauss(const std::vector<Mat>& gaussians, std::vector<Mat>& diffs);
+        PyramidStorage storage_;
+        Mat gray_, input_;                      //grayscale & float copies of the input frame, reused across rebuilds.
+        std::vector<std::vector<Mat>> floatDiffs_;     //float copy of a 16 bit DoG pyramid, for the detector.
+        std::unique_ptr<TaskGraph> graph_;      //parallel build over storage_, rebuilt only when the layout changes.
+        std::vector<int> builtLevels_;          //per octave, how many gaussian levels / DoG levels exist for this frame.
+        std::vector<int> builtDiffs_;
+        std::mutex lazyLock_;
         int numOctaves_ = 0;
         int numImages_ = numOctaves_ + 3;
         float sigma_ = 0.0f;
-        float k_ = pow(2.0f, 1.0f/float(numOctaves_));
+        const ScaleSpace& scales_;      //incremental sigmas & kernels, shared by every pyramid with the same config.
+        PyramidOptions options_;
 };
\ No newline at end of file
@@ -0,0 +1,304 @@
+#include "PyramidCache.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char pyramidMagic[8] = {'G', 'P', 'Y', 'R', 'A', 'M', 'I', 'D'};
+static const size_t payloadAlignment = 64;
+//more octaves than an int sized image can halve into, or more levels than any scale space uses, is a broken header.
+static const int32_t maxFileOctaves = 32;
+static const int32_t maxFileLevels = 64;
+
+static_assert(sizeof(PyramidFileHeader) == 64, "the header is part of the file format");
+static_assert(sizeof(PyramidFileEntry) == 40, "the entries are part of the file format");
+
+uint64_t PyramidCache::hashImage(const Mat& img) {
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](const uchar* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ data[i])*1099511628211ull;
+        }
+    };
+    const int32_t geometry[3] = {img.type(), img.rows, img.cols};
+    add(reinterpret_cast<const uchar*>(geometry), sizeof(geometry));
+    //row by row, the padding between rows isn't part of the image.
+    const size_t rowBytes = img.cols*img.elemSize();
+    for (int y = 0; y < img.rows; ++y) {
+        add(img.ptr<uchar>(y), rowBytes);
+    }
+    return hash;
+}
+
+std::string PyramidCache::path(uint64_t imageHash, int numOctaves, float sigma, int type) const {
+    //sigma by its bits, so two sigmas that print the same can't share a file.
+    uint32_t sigmaBits = 0;
+    std::memcpy(&sigmaBits, &sigma, sizeof(sigmaBits));
+    char name[64];
+    std::snprintf(name, sizeof(name), "%016llx_%d_%08x_%d.gpyr", (unsigned long long)imageHash, numOctaves, sigmaBits, type);
+    return this->directory_ + "/" + name;
+}
+
+std::shared_ptr<MappedPyramid> PyramidCache::load(const Mat& img, int numOctaves, float sigma, PyramidPrecision precision) const {
+    const uint64_t hash = hashImage(img);
+    const int type = GaussPyramid::storageType(precision);
+    std::shared_ptr<MappedPyramid> pyramid = MappedPyramid::open(path(hash, numOctaves, sigma, type));
+    if (!pyramid) {
+        return nullptr;
+    }
+    const PyramidFileHeader& header = pyramid->header();
+    if (header.imageHash != hash || header.numOctaves != numOctaves || header.sigma != sigma || header.type != type) {
+        return nullptr;
+    }
+    return pyramid;
+}
+
+std::shared_ptr<MappedPyramid> PyramidCache::loadOrBuild(Mat& img, int numOctaves, float sigma, const PyramidOptions& options) const {
+    std::shared_ptr<MappedPyramid> pyramid = load(img, numOctaves, sigma, options.precision);
+    if (!pyramid) {
+        GaussPyramid built(img, numOctaves, sigma, options);
+        if (store(img, built)) {
+            pyramid = load(img, numOctaves, sigma, options.precision);
+        }
+    }
+    return pyramid;
+}
+
+bool PyramidCache::store(const Mat& img, GaussPyramid& pyramid) const {
+    const ScaleSpace& scales = pyramid.scaleSpace();
+    const uint64_t hash = hashImage(img);
+    return write(path(hash, scales.numScales(), scales.sigma(), GaussPyramid::storageType(pyramid.precision())), hash, pyramid);
+}
+
+bool PyramidCache::store(const Mat& img, TiledGaussPyramid& pyramid) const {
+    const ScaleSpace& scales = pyramid.scaleSpace();
+    const uint64_t hash = hashImage(img);
+    const int type = GaussPyramid::storageType(pyramid.precision());
+    PyramidFileWriter writer(path(hash, scales.numScales(), scales.sigma(), type), hash, Size(2*img.cols, 2*img.rows),
+                             pyramid.numOctaves(), pyramid.numLevels(), scales.sigma(), type);
+    if (!writer.isOpen()) {
+        return false;
+    }
+    pyramid.build(img, writer.sink());
+    return writer.finish();
+}
+
+bool PyramidCache::write(const std::string& path, uint64_t imageHash, GaussPyramid& pyramid) {
+    const std::vector<std::vector<Mat>>& gaussians = pyramid.gaussPyramid();
+    const std::vector<std::vector<Mat>>& diffs = pyramid.diffPyramid();
+    const Mat& base = gaussians.at(0).at(0);
+    PyramidFileWriter writer(path, imageHash, base.size(), pyramid.numOctaves(), int(gaussians[0].size()), pyramid.scaleSpace().sigma(), base.type());
+    if (!writer.isOpen()) {
+        return false;
+    }
+    for (int o = 0; o < (int)gaussians.size(); ++o) {
+        const Rect rect(0, 0, gaussians[o][0].cols, gaussians[o][0].rows);
+        for (int l = 0; l < (int)gaussians[o].size(); ++l) {
+            writer.write(PyramidTile{o, l, false, rect, gaussians[o][l]});
+        }
+        for (int l = 0; l < (int)diffs[o].size(); ++l) {
+            writer.write(PyramidTile{o, l, true, rect, diffs[o][l]});
+        }
+    }
+    return writer.finish();
+}
+
+
+//every octave's gaussians, then its DoGs, each image 64 byte aligned after the table.
+PyramidFileWriter::PyramidFileWriter(const std::string& path, uint64_t imageHash, Size baseSize, int numOctaves, int numLevels, float sigma, int type)
+    : path_{path}, tmpPath_{path + ".tmp"} {
+    CV_Assert(numOctaves > 0 && numLevels >= 2);
+    for (int o = 0; o < numOctaves; ++o) {
+        const Size size = PyramidStorage::octaveSize(baseSize, o);
+        for (int d = 0; d < 2; ++d) {
+            for (int l = 0; l < numLevels - d; ++l) {
+                PyramidFileEntry entry = {};
+                entry.octave = o;
+                entry.level = l;
+                entry.diff = d;
+                entry.rows = size.height;
+                entry.cols = size.width;
+                entry.step = alignSize(size.width*CV_ELEM_SIZE(type), payloadAlignment);
+                this->entries_.push_back(entry);
+            }
+        }
+    }
+    size_t offset = alignSize(sizeof(PyramidFileHeader) + this->entries_.size()*sizeof(PyramidFileEntry), payloadAlignment);
+    for (PyramidFileEntry& entry : this->entries_) {
+        entry.offset = offset;
+        offset += alignSize(entry.step*entry.rows, payloadAlignment);
+    }
+
+    PyramidFileHeader& header = this->header_;
+    std::memcpy(header.magic, pyramidMagic, sizeof(header.magic));
+    header.version = PyramidCache::version;
+    header.numEntries = uint32_t(this->entries_.size());
+    header.imageHash = imageHash;
+    header.numOctaves = numOctaves;
+    header.numLevels = numLevels;
+    header.sigma = sigma;
+    header.type = type;
+    header.baseWidth = baseSize.width;
+    header.baseHeight = baseSize.height;
+    header.fileSize = offset;
+
+    this->file_.open(this->tmpPath_, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!this->file_) {
+        return;
+    }
+    this->file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    this->file_.write(reinterpret_cast<const char*>(this->entries_.data()), this->entries_.size()*sizeof(PyramidFileEntry));
+    //size the file up front, the padding stays zero.
+    this->file_.seekp(header.fileSize - 1);
+    this->file_.put(0);
+}
+
+PyramidFileWriter::~PyramidFileWriter() {
+    if (!this->finished_) {
+        if (this->file_.is_open()) {
+            this->file_.close();
+        }
+        std::remove(this->tmpPath_.c_str());
+    }
+}
+
+void PyramidFileWriter::write(const PyramidTile& tile) {
+    CV_Assert(0 <= tile.octave && tile.octave < this->header_.numOctaves && tile.image.type() == this->header_.type);
+    const int perOctave = 2*this->header_.numLevels - 1;
+    const PyramidFileEntry& entry = this->entries_.at(tile.octave*perOctave + (tile.diff ? this->header_.numLevels : 0) + tile.level);
+    CV_Assert(tile.rect.x >= 0 && tile.rect.y >= 0 && tile.rect.x + tile.rect.width <= entry.cols && tile.rect.y + tile.rect.height <= entry.rows);
+    CV_Assert(tile.image.size() == tile.rect.size());
+
+    const size_t elemSize = tile.image.elemSize();
+    std::lock_guard<std::mutex> guard(this->lock_);
+    for (int y = 0; y < tile.rect.height; ++y) {
+        this->file_.seekp(entry.offset + (tile.rect.y + y)*entry.step + tile.rect.x*elemSize);
+        this->file_.write(tile.image.ptr<char>(y), tile.rect.width*elemSize);
+    }
+}
+
+bool PyramidFileWriter::finish() {
+    if (!this->file_.is_open()) {
+        return false;
+    }
+    this->file_.flush();
+    const bool ok = bool(this->file_);
+    this->file_.close();
+    if (!ok) {
+        return false;
+    }
+#ifdef _WIN32
+    //rename doesn't replace an existing file on windows. someone else having cached the same pyramid is fine.
+    std::remove(this->path_.c_str());
+#endif
+    this->finished_ = std::rename(this->tmpPath_.c_str(), this->path_.c_str()) == 0;
+    return this->finished_;
+}
+
+
+std::shared_ptr<MappedPyramid> MappedPyramid::open(const std::string& path) {
+    std::shared_ptr<MappedPyramid> pyramid(new MappedPyramid());
+#ifdef _WIN32
+    //no mmap, read the whole file into an aligned buffer instead.
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return nullptr;
+    }
+    pyramid->size_ = size_t(file.tellg());
+    pyramid->buffer_.reset(new uchar[pyramid->size_ + payloadAlignment]);
+    pyramid->data_ = alignPtr(pyramid->buffer_.get(), payloadAlignment);
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(pyramid->data_), pyramid->size_)) {
+        return nullptr;
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(PyramidFileHeader)) {
+        ::close(fd);
+        return nullptr;
+    }
+    pyramid->size_ = size_t(info.st_size);
+    void* data = mmap(nullptr, pyramid->size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);        //the mapping keeps the file alive.
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+    pyramid->data_ = static_cast<uchar*>(data);
+    pyramid->mapped_ = true;
+#endif
+    if (!pyramid->parse()) {
+        return nullptr;
+    }
+    return pyramid;
+}
+
+MappedPyramid::~MappedPyramid() {
+#ifndef _WIN32
+    if (this->mapped_) {
+        munmap(this->data_, this->size_);
+    }
+#endif
+}
+
+//check the header & every entry against the file before handing out headers into it, so a truncated or foreign
+//file is rejected instead of read out of bounds. Every (octave, level) of both pyramids has to be there exactly once.
+bool MappedPyramid::parse() {
+    if (this->size_ < sizeof(PyramidFileHeader)) {
+        return false;
+    }
+    std::memcpy(&this->header_, this->data_, sizeof(PyramidFileHeader));
+    const PyramidFileHeader& header = this->header_;
+    if (std::memcmp(header.magic, pyramidMagic, sizeof(header.magic)) != 0 || header.version != PyramidCache::version ||
+        header.fileSize != this->size_ || header.numOctaves <= 0 || header.numOctaves > maxFileOctaves ||
+        header.numLevels < 2 || header.numLevels > maxFileLevels || header.baseWidth <= 0 || header.baseHeight <= 0 ||
+        uint64_t(header.numEntries) != uint64_t(header.numOctaves)*uint64_t(2*header.numLevels - 1) ||
+        uint64_t(header.numEntries)*sizeof(PyramidFileEntry) > this->size_ - sizeof(PyramidFileHeader)) {
+        return false;
+    }
+    if (header.type != CV_32FC1 && header.type != CV_16FC1 && header.type != CV_16SC1) {
+        return false;
+    }
+
+    this->gaussians_.assign(header.numOctaves, std::vector<Mat>(header.numLevels));
+    this->diffs_.assign(header.numOctaves, std::vector<Mat>(header.numLevels - 1));
+    const PyramidFileEntry* entries = reinterpret_cast<const PyramidFileEntry*>(this->data_ + sizeof(PyramidFileHeader));
+    for (uint32_t i = 0; i < header.numEntries; ++i) {
+        const PyramidFileEntry& entry = entries[i];
+        if ((entry.diff != 0 && entry.diff != 1) ||
+            entry.octave < 0 || entry.octave >= header.numOctaves || entry.level < 0 || entry.level >= header.numLevels - entry.diff ||
+            entry.rows <= 0 || entry.cols <= 0 || entry.step < uint64_t(entry.cols)*CV_ELEM_SIZE(header.type) ||
+            entry.offset % payloadAlignment != 0 || entry.offset > this->size_ ||
+            entry.step > (this->size_ - entry.offset)/uint64_t(entry.rows)) {       //no offset + step*rows, that can wrap.
+            return false;
+        }
+        std::vector<Mat>& octave = entry.diff ? this->diffs_[entry.octave] : this->gaussians_[entry.octave];
+        if (!octave[entry.level].empty()) {
+            return false;           //a duplicate, which also means some other level is missing.
+        }
+        octave[entry.level] = Mat(entry.rows, entry.cols, header.type, this->data_ + entry.offset, entry.step);
+    }
+    //numEntries matches the geometry & there are no duplicates, so every level is set. Checked anyway, a missing
+    //level would otherwise be an empty Mat handed out as part of the pyramid.
+    for (int o = 0; o < header.numOctaves; ++o) {
+        for (const Mat& level : this->gaussians_[o]) {
+            if (level.empty()) {
+                return false;
+            }
+        }
+        for (const Mat& level : this->diffs_[o]) {
+            if (level.empty()) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include "GaussPyramid.hpp"
+#include "TiledGaussPyramid.hpp"
+
+using namespace cv;
+
+//On-disk layout of a cached pyramid (version 1, little endian):
+//  PyramidFileHeader
+//  PyramidFileEntry[numEntries]       one per image: every octave's gaussians, then its DoGs
+//  payloads                           each image's rows back to back, every image starting on a 64 byte boundary
+//The rows keep the padded step of PyramidStorage, so a mapped level is used in place, exactly like an arena level.
+struct PyramidFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t numEntries;
+    uint64_t imageHash;         //PyramidCache::hashImage() of the source image.
+    int32_t numOctaves;
+    int32_t numLevels;          //gaussian levels per octave, the DoG has one less.
+    float sigma;
+    int32_t type;               //CV_32FC1, CV_16FC1 or CV_16SC1, see PyramidPrecision.
+    int32_t baseWidth;          //size of octave 0, i.e. twice the input.
+    int32_t baseHeight;
+    uint64_t fileSize;
+    uint64_t reserved;
+};
+
+struct PyramidFileEntry
+{
+    int32_t octave;
+    int32_t level;
+    int32_t diff;               //0 for a gaussian level, 1 for a DoG level.
+    int32_t rows;
+    int32_t cols;
+    int32_t reserved;
+    uint64_t step;
+    uint64_t offset;            //from the start of the file.
+};
+
+//A cached pyramid mapped into memory. The levels are Mat headers straight into the mapping, so loading one costs
+//the page faults of whatever is actually read, nothing else.
+//The mapping is private: writing to a level doesn't crash, but also doesn't reach the file.
+class MappedPyramid
+{
+    public:
+        static std::shared_ptr<MappedPyramid> open(const std::string& path);
+        ~MappedPyramid();
+        MappedPyramid(const MappedPyramid&) = delete;
+        MappedPyramid& operator=(const MappedPyramid&) = delete;
+        //note: the levels only live as long as the MappedPyramid, clone() them to keep them longer.
+        const std::vector<std::vector<Mat>>& gaussPyramid() const { return this->gaussians_; }
+        const std::vector<std::vector<Mat>>& diffPyramid() const { return this->diffs_; }
+        const std::vector<Mat>& getBlurOctave(int key) const { return this->gaussians_.at(key); }
+        const std::vector<Mat>& getDiffOctave(int key) const { return this->diffs_.at(key); }
+        const PyramidFileHeader& header() const { return this->header_; }
+        int numOctaves() const { return this->header_.numOctaves; }
+        float sigma() const { return this->header_.sigma; }
+        const ScaleSpace& scaleSpace() const { return ScaleSpace::get(this->header_.numOctaves, this->header_.sigma); }
+    private:
+        MappedPyramid() {}
+        bool parse();
+        uchar* data_ = nullptr;
+        size_t size_ = 0;
+        bool mapped_ = false;                   //false: data_ is a plain read of the file (no mmap on _WIN32).
+        std::unique_ptr<uchar[]> buffer_;
+        PyramidFileHeader header_ = {};
+        std::vector<std::vector<Mat>> gaussians_;
+        std::vector<std::vector<Mat>> diffs_;
+};
+
+//Writes the file format level by level or tile by tile, e.g. straight from a TiledGaussPyramid, so a pyramid that doesn't
+//fit in memory can still end up as a cache file. The layout follows from the geometry alone, so it's written up front.
+//The file is written next to path & renamed into place by finish(), so readers never see half a file.
+class PyramidFileWriter
+{
+    public:
+        PyramidFileWriter(const std::string& path, uint64_t imageHash, Size baseSize, int numOctaves, int numLevels, float sigma, int type);
+        ~PyramidFileWriter();           //drops the file if finish() wasn't called.
+        PyramidFileWriter(const PyramidFileWriter&) = delete;
+        PyramidFileWriter& operator=(const PyramidFileWriter&) = delete;
+        bool isOpen() const { return this->file_.is_open(); }
+        //thread safe, tiles can come in any order.
+        void write(const PyramidTile& tile);
+        PyramidTileSink sink() { return [this](const PyramidTile& tile) { write(tile); }; }
+        //returns false if anything failed to write.
+        bool finish();
+    private:
+        std::string path_, tmpPath_;
+        std::fstream file_;
+        PyramidFileHeader header_ = {};
+        std::vector<PyramidFileEntry> entries_;
+        std::mutex lock_;
+        bool finished_ = false;
+};
+
+//A directory of cached pyramids, keyed by the image content, numOctaves, sigma & the storage type of the precision.
+//A pyramid in one precision is never handed out for another: each has its own file.
+class PyramidCache
+{
+    public:
+        explicit PyramidCache(const std::string& directory) : directory_{directory} {}
+        //64 bit FNV-1a over the type, size & pixels of an image.
+        static uint64_t hashImage(const Mat& img);
+        //type is the storage type, GaussPyramid::storageType() of the precision.
+        std::string path(uint64_t imageHash, int numOctaves, float sigma, int type) const;
+        //the cached pyramid of an image in that precision, null if there is none (or the file doesn't check out).
+        std::shared_ptr<MappedPyramid> load(const Mat& img, int numOctaves, float sigma, PyramidPrecision precision = PyramidPrecision::Float32) const;
+        //build the pyramid & cache it if it isn't cached yet, then load it.
+        std::shared_ptr<MappedPyramid> loadOrBuild(Mat& img, int numOctaves, float sigma, const PyramidOptions& options = PyramidOptions()) const;
+        //write a built pyramid of img to the cache, returns false if the file couldn't be written.
+        bool store(const Mat& img, GaussPyramid& pyramid) const;
+        //build the pyramid of img tile by tile straight into the cache, for images too big to build in memory.
+        bool store(const Mat& img, TiledGaussPyramid& pyramid) const;
+        //write a pyramid to any file. It is written next to path & renamed into place, so readers never see half a file.
+        static bool write(const std::string& path, uint64_t imageHash, GaussPyramid& pyramid);
+        static constexpr uint32_t version = 1;
+    private:
+        std::string directory_;
+};
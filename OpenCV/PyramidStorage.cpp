@@ -0,0 +1,57 @@
+#include "PyramidStorage.hpp"
+
+//same size rule as resize(src, dst, Size(), 0.5, 0.5), which the octaves are built with.
+Size PyramidStorage::octaveSize(Size baseSize, int octave) {
+    Size size = baseSize;
+    for (int o = 0; o < octave; ++o) {
+        size = Size(cvRound(size.width*0.5), cvRound(size.height*0.5));
+    }
+    return size;
+}
+
+//rows are padded to the alignment, so every row of every image starts on a cache line.
+//with a null arena this only measures how many bytes the layout needs.
+Mat PyramidStorage::carve(Size size, int type, size_t& offset) {
+    const size_t step = alignSize(size.width*CV_ELEM_SIZE(type), alignment);
+    Mat image;
+    if (this->arena_) {
+        uchar* data = alignPtr(this->arena_.get(), alignment) + offset;
+        image = Mat(size, type, data, step);
+    }
+    offset += step*size.height;
+    return image;
+}
+
+bool PyramidStorage::reset(Size baseSize, int numOctaves, int numLevels, int type) {
+    if (baseSize == this->baseSize_ && numOctaves == this->numOctaves() && numLevels == this->numLevels_ && type == this->type_) {
+        return false;
+    }
+
+    //first pass measures, second pass hands out the headers.
+    for (int pass = 0; pass < 2; ++pass) {
+        size_t offset = 0;
+        this->base_ = carve(baseSize, type, offset);
+        this->gaussians_.assign(numOctaves, std::vector<Mat>());
+        this->diffs_.assign(numOctaves, std::vector<Mat>());
+        for (int o = 0; o < numOctaves; ++o) {
+            Size size = octaveSize(baseSize, o);
+            for (int l = 0; l < numLevels; ++l) {
+                this->gaussians_[o].push_back(carve(size, type, offset));
+            }
+            for (int l = 0; l < numLevels - 1; ++l) {
+                this->diffs_[o].push_back(carve(size, type, offset));
+            }
+        }
+
+        if (pass == 0 && (!this->arena_ || offset > this->capacity_)) {
+            //not touched until the build writes it, so untouched octaves never get paged in.
+            this->arena_.reset(new uchar[offset + alignment]);
+            this->capacity_ = offset;
+        }
+    }
+
+    this->baseSize_ = baseSize;
+    this->numLevels_ = numLevels;
+    this->type_ = type;
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <vector>
+#include <memory>
+
+using namespace cv;
+
+//Every image of a pyramid (the upsampled base, the gaussian levels and the DoG levels of every octave) carved out of
+//one aligned block of memory, which is sized up front and kept across rebuilds.
+//note: the Mats handed out are headers into the arena, they don't own their data. clone() anything that needs to
+//outlive the storage or the next reset() to a different layout.
+class PyramidStorage
+{
+    public:
+        PyramidStorage() {}
+        //lay out numOctaves octaves of numLevels gaussians & numLevels-1 DoGs, octave 0 being baseSize.
+        //returns true if the layout changed. Resetting to the same layout is free, so is a smaller one that fits.
+        bool reset(Size baseSize, int numOctaves, int numLevels, int type = CV_32FC1);
+        static Size octaveSize(Size baseSize, int octave);
+        int numOctaves() const { return int(this->gaussians_.size()); }
+        Mat& base() { return this->base_; }
+        std::vector<Mat>& blurOctave(int octave) { return this->gaussians_[octave]; }
+        std::vector<Mat>& diffOctave(int octave) { return this->diffs_[octave]; }
+        const std::vector<std::vector<Mat>>& gaussians() const { return this->gaussians_; }
+        const std::vector<std::vector<Mat>>& diffs() const { return this->diffs_; }
+        size_t capacity() const { return this->capacity_; }
+    private:
+        static const int alignment = 64;       //cache line, and enough for any SIMD load.
+        Mat carve(Size size, int type, size_t& offset);
+        std::unique_ptr<uchar[]> arena_;
+        size_t capacity_ = 0;
+        Size baseSize_;
+        int numLevels_ = 0;
+        int type_ = -1;
+        Mat base_;
+        std::vector<std::vector<Mat>> gaussians_;
+        std::vector<std::vector<Mat>> diffs_;
+};
@@ -0,0 +1,297 @@
+#include "ScaleSpace.hpp"
+
+using namespace cv;
+
+//level 0 is special: the base of octave 0 is the input upsampled by 2, which is assumed to already carry a blur of
+//2*initialSigma (the SIFT paper assumes 0.5 for the input), so it only needs the difference to reach sigma.
+//the base of every other octave is a downsampled level which is already at sigma, so level 0 is only blurred in octave 0.
+ScaleSpace::ScaleSpace(int numScales, float sigma, float initialSigma) : numScales_{numScales}, sigma_{sigma} {
+    CV_Assert(numScales > 0 && sigma > 0.0f);
+    this->k_ = std::pow(2.0f, 1.0f/float(numScales));
+
+    const float baseSigma = 2.0f*initialSigma;
+    this->increments_.push_back(std::sqrt(std::max(sigma*sigma - baseSigma*baseSigma, 0.01f)));
+    for (int i = 1; i < this->numLevels(); ++i) {
+        float prev = levelSigma(i - 1);
+        float total = levelSigma(i);
+        this->increments_.push_back(std::sqrt(total*total - prev*prev));
+    }
+
+    for (float sig : this->increments_) {
+        //same kernel size GaussianBlur picks for float images.
+        int ksize = cvRound(sig*4*2 + 1) | 1;
+        Mat full = getGaussianKernel(ksize, sig, CV_32F);
+        std::vector<float> half(ksize/2 + 1);
+        for (int i = 0; i < (int)half.size(); ++i) {
+            half[i] = full.at<float>(ksize/2 + i);
+        }
+
+        //round the taps & give whatever rounding left over to the center, so the fixed kernel sums to exactly 1.
+        std::vector<int> fixed(half.size());
+        int sum = 0;
+        for (int i = 1; i < (int)half.size(); ++i) {
+            fixed[i] = cvRound(half[i]*fixedOne);
+            sum += 2*fixed[i];
+        }
+        fixed[0] = fixedOne - sum;
+        float error = std::abs(float(fixed[0])/fixedOne - half[0]);
+        for (int i = 1; i < (int)half.size(); ++i) {
+            error += 2*std::abs(float(fixed[i])/fixedOne - half[i]);
+        }
+
+        this->kernels_.push_back(std::move(half));
+        this->fixedKernels_.push_back(std::move(fixed));
+        this->fixedErrors_.push_back(error);
+    }
+}
+
+const ScaleSpace& ScaleSpace::get(int numScales, float sigma) {
+    static std::mutex lock;
+    static std::map<std::pair<int, float>, std::unique_ptr<ScaleSpace>> cache;
+
+    std::lock_guard<std::mutex> guard(lock);
+    std::unique_ptr<ScaleSpace>& entry = cache[std::make_pair(numScales, sigma)];
+    if (!entry) {
+        entry = std::make_unique<ScaleSpace>(numScales, sigma);
+    }
+    return *entry;
+}
+
+//float & half images are both filtered in float: half levels are only rounded when a row is stored,
+//the intermediate row between the two passes stays in float.
+static inline float loadScalar(float v) { return v; }
+static inline float loadScalar(cv::float16_t v) { return float(v); }
+static inline void storeScalar(float v, float& dst) { dst = v; }
+static inline void storeScalar(float v, cv::float16_t& dst) { dst = cv::float16_t(v); }
+#if CV_SIMD
+static inline v_float32 loadLanes(const float* p) { return vx_load(p); }
+static inline v_float32 loadLanes(const cv::float16_t* p) { return vx_load_expand(p); }
+static inline void storeLanes(float* p, const v_float32& v) { v_store(p, v); }
+static inline void storeLanes(cv::float16_t* p, const v_float32& v) { v_pack_store(p, v); }
+#endif
+
+//rows[0] is the center row, rows[-i] / rows[i] are the rows i above / below it.
+//note: the last vector of a row is shifted back to end at cols instead of running a scalar tail,
+//so every pixel goes through the exact same arithmetic no matter where it sits in the row.
+template<typename T>
+static void verticalPass(const T* const* rows, const float* kern, int r, float* dst, int cols) {
+#if CV_SIMD
+    const int lanes = v_float32::nlanes;
+    if (cols >= lanes) {
+        for (int x = 0; x < cols; x += lanes) {
+            const int xs = std::min(x, cols - lanes);
+            v_float32 acc = loadLanes(rows[0] + xs) * vx_setall_f32(kern[0]);
+            for (int i = 1; i <= r; ++i) {
+                acc = v_muladd(loadLanes(rows[-i] + xs) + loadLanes(rows[i] + xs), vx_setall_f32(kern[i]), acc);
+            }
+            v_store(dst + xs, acc);
+        }
+        return;
+    }
+#endif
+    for (int x = 0; x < cols; ++x) {
+        float acc = loadScalar(rows[0][x])*kern[0];
+        for (int i = 1; i <= r; ++i) {
+            acc += (loadScalar(rows[-i][x]) + loadScalar(rows[i][x]))*kern[i];
+        }
+        dst[x] = acc;
+    }
+}
+
+//row must be readable from row[-r] to row[cols-1+r].
+template<typename T>
+static void horizontalPass(const float* row, const float* kern, int r, T* dst, int cols) {
+#if CV_SIMD
+    const int lanes = v_float32::nlanes;
+    if (cols >= lanes) {
+        for (int x = 0; x < cols; x += lanes) {
+            const int xs = std::min(x, cols - lanes);
+            v_float32 acc = vx_load(row + xs) * vx_setall_f32(kern[0]);
+            for (int i = 1; i <= r; ++i) {
+                acc = v_muladd(vx_load(row + xs - i) + vx_load(row + xs + i), vx_setall_f32(kern[i]), acc);
+            }
+            storeLanes(dst + xs, acc);
+        }
+        return;
+    }
+#endif
+    for (int x = 0; x < cols; ++x) {
+        float acc = row[x]*kern[0];
+        for (int i = 1; i <= r; ++i) {
+            acc += (row[x - i] + row[x + i])*kern[i];
+        }
+        storeScalar(acc, dst[x]);
+    }
+}
+
+//the fixed point passes accumulate in int & round back to Q14 after each pass, so the intermediate row is Q14 too.
+static inline short roundFixed(int acc) {
+    return saturate_cast<short>((acc + (1 << (ScaleSpace::fixedBits - 1))) >> ScaleSpace::fixedBits);
+}
+
+static void verticalPass(const short* const* rows, const int* kern, int r, short* dst, int cols) {
+#if CV_SIMD
+    const int lanes = v_int32::nlanes;
+    if (cols >= lanes) {
+        for (int x = 0; x < cols; x += lanes) {
+            const int xs = std::min(x, cols - lanes);
+            v_int32 acc = vx_load_expand(rows[0] + xs) * vx_setall_s32(kern[0]);
+            for (int i = 1; i <= r; ++i) {
+                acc = acc + (vx_load_expand(rows[-i] + xs) + vx_load_expand(rows[i] + xs)) * vx_setall_s32(kern[i]);
+            }
+            v_rshr_pack_store<ScaleSpace::fixedBits>(dst + xs, acc);
+        }
+        return;
+    }
+#endif
+    for (int x = 0; x < cols; ++x) {
+        int acc = rows[0][x]*kern[0];
+        for (int i = 1; i <= r; ++i) {
+            acc += (rows[-i][x] + rows[i][x])*kern[i];
+        }
+        dst[x] = roundFixed(acc);
+    }
+}
+
+static void horizontalPass(const short* row, const int* kern, int r, short* dst, int cols) {
+#if CV_SIMD
+    const int lanes = v_int32::nlanes;
+    if (cols >= lanes) {
+        for (int x = 0; x < cols; x += lanes) {
+            const int xs = std::min(x, cols - lanes);
+            v_int32 acc = vx_load_expand(row + xs) * vx_setall_s32(kern[0]);
+            for (int i = 1; i <= r; ++i) {
+                acc = acc + (vx_load_expand(row + xs - i) + vx_load_expand(row + xs + i)) * vx_setall_s32(kern[i]);
+            }
+            v_rshr_pack_store<ScaleSpace::fixedBits>(dst + xs, acc);
+        }
+        return;
+    }
+#endif
+    for (int x = 0; x < cols; ++x) {
+        int acc = row[x]*kern[0];
+        for (int i = 1; i <= r; ++i) {
+            acc += (row[x - i] + row[x + i])*kern[i];
+        }
+        dst[x] = roundFixed(acc);
+    }
+}
+
+void ScaleSpace::diffRow(const float* hi, const float* lo, float* dst, int cols) {
+    int x = 0;
+#if CV_SIMD
+    const int lanes = v_float32::nlanes;
+    for (; x <= cols - 2*lanes; x += 2*lanes) {
+        v_store(dst + x, vx_load(hi + x) - vx_load(lo + x));
+        v_store(dst + x + lanes, vx_load(hi + x + lanes) - vx_load(lo + x + lanes));
+    }
+#endif
+    for (; x < cols; ++x) {
+        dst[x] = hi[x] - lo[x];
+    }
+}
+
+void ScaleSpace::diffRow(const cv::float16_t* hi, const cv::float16_t* lo, cv::float16_t* dst, int cols) {
+    int x = 0;
+#if CV_SIMD
+    const int lanes = v_float32::nlanes;
+    for (; x <= cols - lanes; x += lanes) {
+        v_pack_store(dst + x, vx_load_expand(hi + x) - vx_load_expand(lo + x));
+    }
+#endif
+    for (; x < cols; ++x) {
+        dst[x] = cv::float16_t(float(hi[x]) - float(lo[x]));
+    }
+}
+
+//gaussian levels are in [0, 2^14], so the difference can't overflow.
+void ScaleSpace::diffRow(const short* hi, const short* lo, short* dst, int cols) {
+    int x = 0;
+#if CV_SIMD
+    const int lanes = v_int16::nlanes;
+    for (; x <= cols - lanes; x += lanes) {
+        v_store(dst + x, vx_load(hi + x) - vx_load(lo + x));
+    }
+#endif
+    for (; x < cols; ++x) {
+        dst[x] = short(hi[x] - lo[x]);
+    }
+}
+
+//T is the image type, BufT the type of the intermediate row & KernT the kernel type, see the passes above.
+//every index is an image coordinate, src & dst hold the part of the image starting at srcOrigin / dstOrigin.
+//the borders are reflected around the whole image (imageSize), not around src, so a region comes out exactly like
+//the same pixels of a full image blur, as long as src covers rect grown by the radius (clipped to the image).
+template<typename T, typename BufT, typename KernT>
+static void blurRegionImpl(const Mat& src, Point srcOrigin, Mat& dst, Point dstOrigin, Rect rect, Size imageSize, const std::vector<KernT>& kern, Mat* diff) {
+    const int r = int(kern.size()) - 1;
+    const int cols = rect.width;
+    //the vertical pass covers the columns the horizontal pass reads that are inside the image, the rest is reflected.
+    const int x0 = std::max(0, rect.x - r);
+    const int x1 = std::min(imageSize.width, rect.x + cols + r);
+
+    AutoBuffer<BufT> rowBuf(cols + 2*r);
+    AutoBuffer<const T*> rowPtrs(2*r + 1);
+    BufT* row = rowBuf.data() + r;                  //row[i] is column rect.x + i
+    const T** rows = rowPtrs.data() + r;
+
+    for (int y = rect.y; y < rect.y + rect.height; ++y) {
+        for (int i = -r; i <= r; ++i) {
+            rows[i] = src.ptr<T>(borderInterpolate(y + i, imageSize.height, BORDER_REFLECT_101) - srcOrigin.y) + (x0 - srcOrigin.x);
+        }
+        verticalPass(rows, kern.data(), r, row + (x0 - rect.x), x1 - x0);
+
+        for (int x = rect.x - r; x < x0; ++x) {
+            row[x - rect.x] = row[borderInterpolate(x, imageSize.width, BORDER_REFLECT_101) - rect.x];
+        }
+        for (int x = x1; x < rect.x + cols + r; ++x) {
+            row[x - rect.x] = row[borderInterpolate(x, imageSize.width, BORDER_REFLECT_101) - rect.x];
+        }
+        T* dstRow = dst.ptr<T>(y - dstOrigin.y) + (rect.x - dstOrigin.x);
+        horizontalPass(row, kern.data(), r, dstRow, cols);
+
+        //the fused DoG: the new row was just written & the center src row was just read by the vertical pass,
+        //so this saves a full sweep over both levels compared to subtracting them afterwards.
+        if (diff) {
+            ScaleSpace::diffRow(dstRow, rows[0] + (rect.x - x0), diff->ptr<T>(y - dstOrigin.y) + (rect.x - dstOrigin.x), cols);
+        }
+    }
+}
+
+void ScaleSpace::blur(const Mat& src, Mat& dst, int level) const {
+    CV_Assert(src.data != dst.data);
+    dst.create(src.size(), src.type());
+    blurRows(src, dst, level, 0, src.rows);
+}
+
+//the separable blur is done vertical first, one output row at a time: the vertical pass writes into a padded row buffer,
+//which is then filtered horizontally straight into dst. Rows are independent, so any band of rows can be computed on its own.
+void ScaleSpace::blurRows(const Mat& src, Mat& dst, int level, int y0, int y1, Mat* diff) const {
+    CV_Assert(src.size() == dst.size() && (!diff || diff->size() == dst.size()));
+    CV_Assert(0 <= y0 && y0 <= y1 && y1 <= src.rows);
+    blurRegion(src, Point(0, 0), dst, Point(0, 0), Rect(0, y0, src.cols, y1 - y0), src.size(), level, diff);
+}
+
+void ScaleSpace::blurRegion(const Mat& src, Point srcOrigin, Mat& dst, Point dstOrigin, Rect rect, Size imageSize, int level, Mat* diff) const {
+    CV_Assert(src.type() == dst.type() && src.channels() == 1 && (!diff || diff->type() == dst.type()));
+    CV_Assert(rect.x >= 0 && rect.y >= 0 && rect.x + rect.width <= imageSize.width && rect.y + rect.height <= imageSize.height);
+    if (rect.width <= 0 || rect.height <= 0) {
+        return;
+    }
+    //the source rows & the output, plus the lower level re-read & the DoG written when fused.
+    TRACE_SCOPE("pyramid.blur", uint64_t(rect.width)*(rect.height*(diff ? 4 : 2) + 2*radius(level))*src.elemSize(), level);
+
+    switch (src.depth()) {
+        case CV_32F:
+            blurRegionImpl<float, float>(src, srcOrigin, dst, dstOrigin, rect, imageSize, this->kernels_.at(level), diff);
+            break;
+        case CV_16F:
+            blurRegionImpl<cv::float16_t, float>(src, srcOrigin, dst, dstOrigin, rect, imageSize, this->kernels_.at(level), diff);
+            break;
+        case CV_16S:
+            blurRegionImpl<short, short>(src, srcOrigin, dst, dstOrigin, rect, imageSize, this->fixedKernels_.at(level), diff);
+            break;
+        default:
+            CV_Error(Error::StsUnsupportedFormat, "ScaleSpace only blurs CV_32F, CV_16F & CV_16S images");
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <cmath>
+#include "Trace.hpp"
+
+using namespace cv;
+
+//The blur schedule of a SIFT scale space for a single (numScales, sigma) configuration.
+//level i of every octave should carry an absolute blur of sigma*k^i, where k = 2^(1/numScales).
+//since blurs add in quadrature, each level is blurred from the previous level with the incremental sigma
+//      sig_i = sqrt( (sigma*k^i)^2 - (sigma*k^(i-1))^2 )
+//which is the smallest kernel that reaches the correct scale.
+//The sigmas and kernels only depend on the configuration, so use ScaleSpace::get() to share them between pyramids.
+//Images can be CV_32F, CV_16F (stored as half, accumulated in float) or CV_16S fixed point, where a value v is stored
+//as round(v * 2^fixedBits) and blurred with integer kernels that sum to exactly 2^fixedBits.
+class ScaleSpace
+{
+    public:
+        static constexpr int fixedBits = 14;                //Q14: [0,1] maps to [0, 16384], and 2^14 * 2^14 still fits an int accumulator.
+        static constexpr int fixedOne = 1 << fixedBits;
+        ScaleSpace(int numScales, float sigma, float initialSigma = 0.5f);
+        static const ScaleSpace& get(int numScales, float sigma);
+        int numScales() const { return numScales_; }
+        int numLevels() const { return numScales_ + 3; }
+        float sigma() const { return sigma_; }
+        float k() const { return k_; }
+        float levelSigma(int level) const { return sigma_*std::pow(k_, float(level)); }
+        float incrementSigma(int level) const { return this->increments_.at(level); }
+        int radius(int level) const { return int(this->kernels_.at(level).size()) - 1; }
+        const std::vector<float>& kernel(int level) const { return this->kernels_.at(level); }
+        const std::vector<int>& fixedKernel(int level) const { return this->fixedKernels_.at(level); }
+        //L1 norm of (fixed kernel / 2^fixedBits - float kernel) over the full kernel, i.e. the most a 1D fixed point pass
+        //can differ from the float one on an image in [0,1], rounding aside.
+        float fixedKernelError(int level) const { return this->fixedErrors_.at(level); }
+        //blur src with the incremental kernel of a level. src and dst must have the same single channel type & not share data.
+        void blur(const Mat& src, Mat& dst, int level) const;
+        //only computes dst rows [y0, y1), reading whichever src rows the kernel needs.
+        //if diff is given, the difference of gaussians dst - src is written for those rows too, while both rows are still in cache.
+        void blurRows(const Mat& src, Mat& dst, int level, int y0, int y1, Mat* diff = nullptr) const;
+        //the same blur for any rect of an image of imageSize, where src & dst (and diff) only hold part of the image, starting at
+        //srcOrigin & dstOrigin. src has to cover rect grown by radius(level), clipped to the image. Bit-identical to blurRows.
+        void blurRegion(const Mat& src, Point srcOrigin, Mat& dst, Point dstOrigin, Rect rect, Size imageSize, int level, Mat* diff = nullptr) const;
+        //dst = hi - lo over a row, vectorized.
+        static void diffRow(const float* hi, const float* lo, float* dst, int cols);
+        static void diffRow(const cv::float16_t* hi, const cv::float16_t* lo, cv::float16_t* dst, int cols);
+        static void diffRow(const short* hi, const short* lo, short* dst, int cols);
+    private:
+        int numScales_ = 0;
+        float sigma_ = 0.0f;
+        float k_ = 1.0f;
+        std::vector<float> increments_;
+        std::vector<std::vector<float>> kernels_;      //half kernels: [center, 1, 2, ..., radius]
+        std::vector<std::vector<int>> fixedKernels_;   //same, in Q14
+        std::vector<float> fixedErrors_;
+};
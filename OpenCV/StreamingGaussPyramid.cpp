@@ -0,0 +1,184 @@
+#include "StreamingGaussPyramid.hpp"
+
+StreamingGaussPyramid::Frame& StreamingGaussPyramid::Frame::operator=(Frame&& other) noexcept {
+    if (this != &other) {
+        release();
+        this->shared_ = std::move(other.shared_);
+        this->slot_ = other.slot_;
+    }
+    return *this;
+}
+
+int64_t StreamingGaussPyramid::Frame::index() const { return this->shared_->slots[this->slot_].index; }
+const GaussPyramid& StreamingGaussPyramid::Frame::pyramid() const { return *this->shared_->slots[this->slot_].pyramid; }
+const KeypointArray& StreamingGaussPyramid::Frame::keypoints() const { return this->shared_->slots[this->slot_].keypoints; }
+
+void StreamingGaussPyramid::Frame::release() {
+    if (this->shared_) {
+        {
+            std::lock_guard<std::mutex> guard(this->shared_->lock);
+            --this->shared_->slots[this->slot_].readers;
+        }
+        this->shared_->changed.notify_all();
+        this->shared_.reset();
+    }
+}
+
+
+StreamingGaussPyramid::StreamingGaussPyramid(int numOctaves, float sigma, const StreamingOptions& options)
+    : numOctaves_{numOctaves}, sigma_{sigma}, options_{options} {
+    CV_Assert(options.numSlots >= 2);
+    this->options_.pyramid.lazy = false;
+    this->shared_ = std::make_shared<Shared>();
+    this->shared_->slots.resize(options.numSlots);
+    this->builder_ = std::thread(&StreamingGaussPyramid::buildLoop, this);
+    this->detector_ = std::thread(&StreamingGaussPyramid::detectLoop, this);
+}
+
+StreamingGaussPyramid::~StreamingGaussPyramid() {
+    {
+        std::lock_guard<std::mutex> guard(this->shared_->lock);
+        this->stop_ = true;
+    }
+    this->shared_->changed.notify_all();
+    this->builder_.join();
+    this->detector_.join();
+}
+
+//the slot holding the oldest frame in a given state, -1 if there is none.
+int StreamingGaussPyramid::oldest(State state) const {
+    int found = -1;
+    for (int i = 0; i < (int)this->shared_->slots.size(); ++i) {
+        if (this->shared_->slots[i].state == state && (found < 0 || this->shared_->slots[i].index < this->shared_->slots[found].index)) {
+            found = i;
+        }
+    }
+    return found;
+}
+
+//a slot nobody needs anymore: never used, or a finished frame that has been superseded and isn't being read.
+int StreamingGaussPyramid::reusableSlot() const {
+    int found = oldest(State::Free);
+    if (found >= 0) {
+        return found;
+    }
+    for (int i = 0; i < (int)this->shared_->slots.size(); ++i) {
+        const Slot& slot = this->shared_->slots[i];
+        if (slot.state == State::Ready && i != this->shared_->latest && slot.readers == 0 && (found < 0 || slot.index < this->shared_->slots[found].index)) {
+            found = i;
+        }
+    }
+    return found;
+}
+
+int64_t StreamingGaussPyramid::update(const Mat& frame) {
+    std::unique_lock<std::mutex> guard(this->shared_->lock);
+    int slot = reusableSlot();
+    if (slot < 0 && this->options_.dropFrames) {
+        return -1;
+    }
+    this->shared_->changed.wait(guard, [&]{ slot = reusableSlot(); return slot >= 0; });
+
+    //the slot is ours until it's queued, so copy outside the lock. copyTo reuses the slot's buffer.
+    Slot& s = this->shared_->slots[slot];
+    s.state = State::Building;
+    s.index = this->nextIndex_++;
+    guard.unlock();
+    frame.copyTo(s.frame);
+    guard.lock();
+    s.state = State::Queued;
+    const int64_t index = s.index;
+    guard.unlock();
+    this->shared_->changed.notify_all();
+    return index;
+}
+
+void StreamingGaussPyramid::buildLoop() {
+    std::unique_lock<std::mutex> guard(this->shared_->lock);
+    while (true) {
+        int slot = -1;
+        this->shared_->changed.wait(guard, [&]{ slot = oldest(State::Queued); return this->stop_ || slot >= 0; });
+        if (this->stop_) {
+            return;
+        }
+        Slot& s = this->shared_->slots[slot];
+        s.state = State::Building;
+        guard.unlock();
+
+        if (!s.pyramid) {
+            s.pyramid = std::make_unique<GaussPyramid>(s.frame, this->numOctaves_, this->sigma_, this->options_.pyramid);
+        }
+        else {
+            s.pyramid->rebuild(s.frame);
+        }
+
+        guard.lock();
+        if (this->options_.detectExtrema) {
+            s.state = State::Built;
+            this->shared_->changed.notify_all();
+        }
+        else {
+            publish(slot);
+        }
+    }
+}
+
+void StreamingGaussPyramid::detectLoop() {
+    std::unique_lock<std::mutex> guard(this->shared_->lock);
+    while (true) {
+        int slot = -1;
+        this->shared_->changed.wait(guard, [&]{ slot = oldest(State::Built); return this->stop_ || slot >= 0; });
+        if (this->stop_) {
+            return;
+        }
+        Slot& s = this->shared_->slots[slot];
+        s.state = State::Detecting;
+        guard.unlock();
+
+        s.pyramid->detectExtrema(s.keypoints, this->options_.extrema);
+
+        guard.lock();
+        publish(slot);
+    }
+}
+
+//called with shared_->lock held.
+void StreamingGaussPyramid::publish(int slot) {
+    this->shared_->slots[slot].state = State::Ready;
+    if (this->shared_->latest < 0 || this->shared_->slots[slot].index > this->shared_->slots[this->shared_->latest].index) {
+        this->shared_->latest = slot;
+    }
+    this->shared_->changed.notify_all();
+}
+
+//called with shared_->lock held.
+StreamingGaussPyramid::Frame StreamingGaussPyramid::acquire(int slot) {
+    ++this->shared_->slots[slot].readers;
+    return Frame(this->shared_, slot);
+}
+
+StreamingGaussPyramid::Frame StreamingGaussPyramid::latest() {
+    std::lock_guard<std::mutex> guard(this->shared_->lock);
+    if (this->shared_->latest < 0) {
+        return Frame();
+    }
+    return acquire(this->shared_->latest);
+}
+
+StreamingGaussPyramid::Frame StreamingGaussPyramid::waitNext(int64_t after) {
+    std::unique_lock<std::mutex> guard(this->shared_->lock);
+    this->shared_->changed.wait(guard, [&]{ return this->shared_->latest >= 0 && this->shared_->slots[this->shared_->latest].index > after; });
+    return acquire(this->shared_->latest);
+}
+
+void StreamingGaussPyramid::flush() {
+    std::unique_lock<std::mutex> guard(this->shared_->lock);
+    this->shared_->changed.wait(guard, [&]{
+        for (const Slot& slot : this->shared_->slots) {
+            if (slot.state != State::Free && slot.state != State::Ready) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "GaussPyramid.hpp"
+
+using namespace cv;
+
+struct StreamingOptions
+{
+    PyramidOptions pyramid;         //how each frame's pyramid is built (lazy is ignored).
+    ExtremaOptions extrema;
+    bool detectExtrema = true;
+    //frames in flight: one building, one in extrema detection, the rest published to readers.
+    //every slot keeps its own pyramid, so memory is bounded by numSlots pyramids.
+    int numSlots = 3;
+    //what update() does when every slot is busy: false waits for one, true drops the new frame.
+    bool dropFrames = false;
+};
+
+//GaussPyramid for a continuous stream of frames.
+//frames go through a pipeline of two threads, the pyramid build (upsample, blur & fused DoG) and extrema detection,
+//so frame N+1 builds while frame N is being detected and frame N-1 is being read. Every slot keeps its pyramid
+//between frames, so once the stream runs at a fixed size nothing is reallocated.
+class StreamingGaussPyramid
+{
+        struct Shared;
+    public:
+        //a published frame. The slot isn't reused while a Frame points at it, so hold on to it only as long as needed.
+        //A Frame shares ownership of the slots, so it stays valid even after the StreamingGaussPyramid is gone.
+        class Frame
+        {
+            public:
+                Frame() {}
+                Frame(Frame&& other) noexcept : shared_{std::move(other.shared_)}, slot_{other.slot_} {}
+                Frame& operator=(Frame&& other) noexcept;
+                Frame(const Frame&) = delete;
+                Frame& operator=(const Frame&) = delete;
+                ~Frame() { release(); }
+                bool empty() const { return this->shared_ == nullptr; }
+                int64_t index() const;
+                //read only: the pyramid is shared with every other reader of the frame, and the slot is rebuilt in place
+                //once the last one lets go. Frames are never lazy, so every const accessor of GaussPyramid works.
+                const GaussPyramid& pyramid() const;
+                const KeypointArray& keypoints() const;
+                void release();
+            private:
+                friend class StreamingGaussPyramid;
+                Frame(std::shared_ptr<Shared> shared, int slot) : shared_{std::move(shared)}, slot_{slot} {}
+                std::shared_ptr<Shared> shared_;
+                int slot_ = -1;
+        };
+
+        StreamingGaussPyramid(int numOctaves, float sigma, const StreamingOptions& options = StreamingOptions());
+        //frames still queued or in flight are discarded (the one being built or detected is finished first), call
+        //flush() first to finish them. Frames already handed out stay valid.
+        ~StreamingGaussPyramid();
+        StreamingGaussPyramid(const StreamingGaussPyramid&) = delete;
+        StreamingGaussPyramid& operator=(const StreamingGaussPyramid&) = delete;
+
+        //queue a frame, returns its index (or -1 if it was dropped). The frame is copied, so the caller can reuse it.
+        int64_t update(const Mat& frame);
+        //the most recent finished frame, empty if there is none yet.
+        Frame latest();
+        //blocks until a frame newer than 'after' is finished.
+        Frame waitNext(int64_t after);
+        //blocks until every queued frame is finished.
+        void flush();
+    private:
+        enum class State { Free, Queued, Building, Built, Detecting, Ready };
+        struct Slot {
+            Mat frame;
+            std::unique_ptr<GaussPyramid> pyramid;
+            KeypointArray keypoints;
+            int64_t index = -1;
+            State state = State::Free;
+            int readers = 0;
+        };
+        //what the threads & the Frames share, kept alive by whichever of them is last.
+        struct Shared {
+            std::vector<Slot> slots;
+            int latest = -1;
+            std::mutex lock;
+            std::condition_variable changed;
+        };
+        void buildLoop();
+        void detectLoop();
+        int oldest(State state) const;
+        int reusableSlot() const;
+        Frame acquire(int slot);
+        void publish(int slot);
+        int numOctaves_ = 0;
+        float sigma_ = 0.0f;
+        StreamingOptions options_;
+        std::shared_ptr<Shared> shared_;
+        int64_t nextIndex_ = 0;
+        bool stop_ = false;             //guarded by shared_->lock.
+        std::thread builder_;
+        std::thread detector_;
+};
@@ -0,0 +1,181 @@
+#include "TaskScheduler.hpp"
+
+//which scheduler & worker the current thread belongs to, so tasks spawned from a task stay on the same worker.
+static thread_local const TaskScheduler* currentScheduler = nullptr;
+static thread_local int currentWorker = -1;
+
+TaskScheduler::TaskScheduler(int numThreads) {
+    if (numThreads <= 0) {
+        numThreads = std::max(1, int(std::thread::hardware_concurrency()));
+    }
+    for (int i = 0; i < numThreads; ++i) {
+        this->workers_.push_back(std::make_unique<Worker>());
+    }
+    //start the threads only once every deque exists, since workers steal from each other.
+    for (int i = 0; i < numThreads; ++i) {
+        this->workers_[i]->thread = std::thread(&TaskScheduler::workerLoop, this, i);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> guard(this->sleepLock_);
+        this->stop_ = true;
+    }
+    this->wake_.notify_all();
+    for (auto& worker : this->workers_) {
+        worker->thread.join();
+    }
+}
+
+TaskScheduler& TaskScheduler::get(int numThreads) {
+    static std::mutex lock;
+    static std::map<int, std::unique_ptr<TaskScheduler>> pools;
+
+    if (numThreads <= 0) {
+        numThreads = std::max(1, int(std::thread::hardware_concurrency()));
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    std::unique_ptr<TaskScheduler>& pool = pools[numThreads];
+    if (!pool) {
+        pool = std::make_unique<TaskScheduler>(numThreads);
+    }
+    return *pool;
+}
+
+bool TaskScheduler::onWorker() const {
+    return currentScheduler == this;
+}
+
+void TaskScheduler::submit(std::function<void()> task) {
+    int index = 0;
+    if (currentScheduler == this) {
+        index = currentWorker;
+    }
+    else {
+        index = int(this->nextWorker_++ % this->workers_.size());
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(this->workers_[index]->lock);
+        this->workers_[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> guard(this->sleepLock_);
+        ++this->queued_;
+    }
+    this->wake_.notify_one();
+}
+
+bool TaskScheduler::popTask(int index, std::function<void()>& task) {
+    //own work first, newest task.
+    {
+        Worker& own = *this->workers_[index];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    //otherwise steal the oldest task of another worker.
+    const int n = int(this->workers_.size());
+    for (int i = 1; i < n; ++i) {
+        Worker& victim = *this->workers_[(index + i) % n];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::workerLoop(int index) {
+    currentScheduler = this;
+    currentWorker = index;
+
+    std::function<void()> task;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(this->sleepLock_);
+            this->wake_.wait(guard, [this]{ return this->stop_ || this->queued_ > 0; });
+            if (this->queued_ == 0) {
+                return;     //stopping, and nothing left to run.
+            }
+            --this->queued_;
+        }
+        //a task was counted in queued_ before it could be popped, so one of the deques holds it (or will shortly).
+        while (!popTask(index, task)) {
+            std::this_thread::yield();
+        }
+        task();
+        task = nullptr;
+    }
+}
+
+
+int TaskGraph::add(std::function<void()> fn) {
+    this->nodes_.emplace_back();
+    this->nodes_.back().fn = std::move(fn);
+    return int(this->nodes_.size()) - 1;
+}
+
+void TaskGraph::precede(int before, int after) {
+    this->nodes_.at(before).successors.push_back(after);
+    ++this->nodes_.at(after).numDeps;
+}
+
+void TaskGraph::runNode(int id, TaskScheduler& scheduler) {
+    Node& node = this->nodes_[id];
+    //once a task has failed, the rest of the graph is only walked to completion, not executed.
+    if (!this->failed_) {
+        try {
+            node.fn();
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> guard(this->doneLock_);
+            if (!this->failed_.exchange(true)) {
+                this->error_ = std::current_exception();
+            }
+        }
+    }
+
+    for (int next : node.successors) {
+        if (--this->nodes_[next].pending == 0) {
+            scheduler.submit([this, next, &scheduler]{ runNode(next, scheduler); });
+        }
+    }
+
+    //decrement & notify under doneLock_: run() can't see remaining_ == 0 (and return, destroying the graph)
+    //until this thread has released the lock, which is its last use of 'this'.
+    std::lock_guard<std::mutex> guard(this->doneLock_);
+    if (--this->remaining_ == 0) {
+        this->done_.notify_all();
+    }
+}
+
+void TaskGraph::run(TaskScheduler& scheduler) {
+    if (this->nodes_.empty()) {
+        return;
+    }
+    this->failed_ = false;
+    this->error_ = nullptr;
+    this->remaining_ = this->size();
+    for (Node& node : this->nodes_) {
+        node.pending = node.numDeps;
+    }
+
+    for (int id = 0; id < this->size(); ++id) {
+        if (this->nodes_[id].numDeps == 0) {
+            scheduler.submit([this, id, &scheduler]{ runNode(id, scheduler); });
+        }
+    }
+
+    std::unique_lock<std::mutex> guard(this->doneLock_);
+    this->done_.wait(guard, [this]{ return this->remaining_ == 0; });
+    if (this->error_) {
+        std::rethrow_exception(this->error_);
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <exception>
+
+//A small work-stealing thread pool.
+//every worker owns a deque of tasks. It pushes & pops its own work at the back (newest first, still warm in cache),
+//while idle workers steal from the front of the other deques (oldest first, usually the work that fans out the most).
+class TaskScheduler
+{
+    public:
+        explicit TaskScheduler(int numThreads = 0);        //0 = one worker per core
+        ~TaskScheduler();
+        TaskScheduler(const TaskScheduler&) = delete;
+        TaskScheduler& operator=(const TaskScheduler&) = delete;
+        static TaskScheduler& get(int numThreads);         //shared pool per thread count, so pools aren't spun up per frame
+        int numThreads() const { return int(this->workers_.size()); }
+        bool onWorker() const;                              //whether the calling thread is one of this pool's workers
+        void submit(std::function<void()> task);
+    private:
+        struct Worker {
+            std::deque<std::function<void()>> tasks;
+            std::mutex lock;
+            std::thread thread;
+        };
+        void workerLoop(int index);
+        bool popTask(int index, std::function<void()>& task);
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::mutex sleepLock_;
+        std::condition_variable wake_;
+        int queued_ = 0;                                    //guarded by sleepLock_
+        bool stop_ = false;
+        std::atomic<unsigned> nextWorker_{0};
+};
+
+
+//A DAG of tasks run on a TaskScheduler. A task is submitted as soon as every task it depends on has finished,
+//so there are no barriers between 'stages' unless the graph asks for them.
+//note: run() blocks the calling thread, so don't call it from inside a task of the same scheduler.
+class TaskGraph
+{
+    public:
+        int add(std::function<void()> fn);
+        void precede(int before, int after);                //'after' can only start once 'before' is done
+        void run(TaskScheduler& scheduler);                 //rethrows the first exception thrown by a task
+        int size() const { return int(this->nodes_.size()); }
+    private:
+        struct Node {
+            std::function<void()> fn;
+            std::vector<int> successors;
+            int numDeps = 0;
+            std::atomic<int> pending{0};
+        };
+        void runNode(int id, TaskScheduler& scheduler);
+        std::deque<Node> nodes_;                            //deque, since Node (atomic) can't be moved when growing
+        std::atomic<int> remaining_{0};
+        std::atomic<bool> failed_{false};
+        std::exception_ptr error_;
+        std::mutex doneLock_;
+        std::condition_variable done_;
+};
@@ -0,0 +1,200 @@
+#include "TiledGaussPyramid.hpp"
+#include <atomic>
+
+//regions narrower than this are widened, so every blur row goes through the vector path of the passes exactly like the
+//full image does (see ScaleSpace). Wider than the widest SIMD register holds floats or ints.
+static const int minRegionWidth = 32;
+
+static Rect unite(const Rect& a, const Rect& b) {
+    if (a.width <= 0 || a.height <= 0) {
+        return b;
+    }
+    if (b.width <= 0 || b.height <= 0) {
+        return a;
+    }
+    const int x0 = std::min(a.x, b.x), y0 = std::min(a.y, b.y);
+    const int x1 = std::max(a.x + a.width, b.x + b.width), y1 = std::max(a.y + a.height, b.y + b.height);
+    return Rect(x0, y0, x1 - x0, y1 - y0);
+}
+
+static Rect grow(const Rect& r, int by, Size size) {
+    if (r.width <= 0 || r.height <= 0) {
+        return r;
+    }
+    const int x0 = std::max(0, r.x - by), y0 = std::max(0, r.y - by);
+    const int x1 = std::min(size.width, r.x + r.width + by), y1 = std::min(size.height, r.y + r.height + by);
+    return Rect(x0, y0, x1 - x0, y1 - y0);
+}
+
+static Rect widen(const Rect& r, int imageWidth) {
+    if (r.width <= 0 || r.height <= 0 || r.width >= minRegionWidth) {
+        return r;
+    }
+    const int width = std::min(minRegionWidth, imageWidth);
+    const int x = std::max(0, std::min(r.x, imageWidth - width));
+    return Rect(x, r.y, width, r.height);
+}
+
+//a view of rect's size into buf, which only ever grows.
+static Mat view(Mat& buf, Size size, int type) {
+    if (buf.empty() || buf.type() != type || buf.cols < size.width || buf.rows < size.height) {
+        buf.create(std::max(size.height, buf.empty() ? 0 : buf.rows), std::max(size.width, buf.empty() ? 0 : buf.cols), type);
+    }
+    return buf(Rect(0, 0, size.width, size.height));
+}
+
+TiledGaussPyramid::TiledGaussPyramid(int numOctaves, float sigma, int tileSize, const PyramidOptions& options)
+    : numOctaves_{numOctaves}, numImages_{numOctaves + 3}, scales_{ScaleSpace::get(numOctaves, sigma)}, options_{options} {
+    CV_Assert(numOctaves > 0 && tileSize > 0);
+    const int grid = 1 << (numOctaves - 1);
+    this->tileSize_ = (tileSize + grid - 1)/grid*grid;
+}
+
+size_t TiledGaussPyramid::Buffers::bytes() const {
+    size_t total = this->gray.total()*this->gray.elemSize() + this->input.total()*this->input.elemSize() +
+                   this->base.total()*this->base.elemSize() + this->diff.total()*this->diff.elemSize();
+    for (const std::vector<Mat>& octave : this->levels) {
+        for (const Mat& level : octave) {
+            total += level.total()*level.elemSize();
+        }
+    }
+    return total;
+}
+
+//works backwards from the output: a level needs its own output, the level above it grown by that level's radius,
+//and (level numOctaves_) the pixels the next octave's base samples. Octave 0's base needs the level 0 blur's halo,
+//and the input needs the two taps of the upsampling.
+TiledGaussPyramid::Plan TiledGaussPyramid::plan(Size inputSize, int tx, int ty, int numTilesX, int numTilesY) const {
+    Plan p;
+    const Size baseSize(2*inputSize.width, 2*inputSize.height);
+    p.levels.assign(this->numOctaves_, std::vector<Rect>(this->numImages_));
+    p.output.resize(this->numOctaves_);
+
+    for (int o = 0; o < this->numOctaves_; ++o) {
+        const Size size = PyramidStorage::octaveSize(baseSize, o);
+        const int x0 = (tx*this->tileSize_) >> o, y0 = (ty*this->tileSize_) >> o;
+        const int x1 = tx == numTilesX - 1 ? size.width : ((tx + 1)*this->tileSize_) >> o;
+        const int y1 = ty == numTilesY - 1 ? size.height : ((ty + 1)*this->tileSize_) >> o;
+        p.output[o] = x0 < x1 && y0 < y1 ? Rect(x0, y0, x1 - x0, y1 - y0) : Rect();
+    }
+
+    for (int o = this->numOctaves_ - 1; o >= 0; --o) {
+        const Size size = PyramidStorage::octaveSize(baseSize, o);
+        for (int l = this->numImages_ - 1; l >= 0; --l) {
+            Rect need = p.output[o];
+            if (l < this->numImages_ - 1) {
+                need = unite(need, grow(p.levels[o][l+1], this->scales_.radius(l+1), size));
+            }
+            const Rect& next = o + 1 < this->numOctaves_ ? p.levels[o+1][0] : Rect();
+            if (l == this->numOctaves_ && next.width > 0 && next.height > 0) {
+                need = unite(need, Rect(2*next.x, 2*next.y, 2*next.width - 1, 2*next.height - 1));
+            }
+            p.levels[o][l] = widen(need, size.width);
+        }
+    }
+
+    p.base = widen(grow(p.levels[0][0], this->scales_.radius(0), baseSize), baseSize.width);
+    const int ix0 = std::max(0, (p.base.x - 1) >> 1), iy0 = std::max(0, (p.base.y - 1) >> 1);
+    const int ix1 = std::min(inputSize.width, ((p.base.x + p.base.width - 1) >> 1) + 2);
+    const int iy1 = std::min(inputSize.height, ((p.base.y + p.base.height - 1) >> 1) + 2);
+    p.input = Rect(ix0, iy0, ix1 - ix0, iy1 - iy0);
+    return p;
+}
+
+//same steps as GaussPyramid::createPyramidSerial, on the planned rects only.
+void TiledGaussPyramid::buildTile(const Mat& img, const Plan& p, Buffers& buffers, const PyramidTileSink& sink, std::mutex& sinkLock) const {
+    const int type = GaussPyramid::storageType(this->options_.precision);
+    const Size baseSize(2*img.cols, 2*img.rows);
+    const double scale = this->options_.precision == PyramidPrecision::Fixed16 ? ScaleSpace::fixedOne : 1.0;
+    if (p.levels[0][0].width <= 0) {
+        return;
+    }
+
+    //the same conversion GaussPyramid does on the whole image.
+    const Mat roi = img(p.input);
+    const Mat& gray = GaussPyramid::grayInput(roi, buffers.gray);
+    Mat input = view(buffers.input, p.input.size(), CV_32FC1);
+    gray.convertTo(input, CV_32F, gray.depth() == CV_8U ? 1.0/255.0 : 1.0);
+
+    Mat base = view(buffers.base, p.base.size(), type);
+    GaussPyramid::upsampleRegion(input, p.input.tl(), img.size(), base, p.base.tl(), p.base, scale);
+
+    buffers.levels.resize(this->numOctaves_, std::vector<Mat>(this->numImages_));
+    std::vector<Mat> levels(this->numImages_);
+    std::vector<Mat> prevLevels;
+    for (int o = 0; o < this->numOctaves_; ++o) {
+        const Size size = PyramidStorage::octaveSize(baseSize, o);
+        const std::vector<Rect>& rects = p.levels[o];
+        if (rects[0].width <= 0) {
+            break;      //nothing of this tile is left in the coarser octaves.
+        }
+        for (int l = 0; l < this->numImages_; ++l) {
+            levels[l] = view(buffers.levels[o][l], rects[l].size(), type);
+        }
+
+        if (o == 0) {
+            this->scales_.blurRegion(base, p.base.tl(), levels[0], rects[0].tl(), rects[0], size, 0);
+        }
+        else {
+            GaussPyramid::downsampleRegion(prevLevels[this->numOctaves_], p.levels[o-1][this->numOctaves_].tl(), levels[0], rects[0].tl(), rects[0]);
+        }
+        for (int l = 1; l < this->numImages_; ++l) {
+            this->scales_.blurRegion(levels[l-1], rects[l-1].tl(), levels[l], rects[l].tl(), rects[l], size, l);
+        }
+
+        //the DoG is only needed on the output, so it's a separate (exact) subtraction instead of being fused into the halos.
+        const Rect& out = p.output[o];
+        if (out.width > 0 && out.height > 0) {
+            auto emit = [&](const PyramidTile& tile) {
+                std::lock_guard<std::mutex> guard(sinkLock);
+                sink(tile);
+            };
+            Mat diff = view(buffers.diff, out.size(), type);
+            for (int l = 0; l < this->numImages_; ++l) {
+                emit(PyramidTile{o, l, false, out, levels[l](out - rects[l].tl())});
+            }
+            for (int l = 0; l < this->numImages_ - 1; ++l) {
+                GaussPyramid::diffRows(levels[l+1](out - rects[l+1].tl()), levels[l](out - rects[l].tl()), diff, 0, diff.rows);
+                emit(PyramidTile{o, l, true, out, diff});
+            }
+        }
+        prevLevels = levels;
+    }
+}
+
+void TiledGaussPyramid::build(const Mat& img, const PyramidTileSink& sink) {
+    CV_Assert(!img.empty() && (img.channels() == 1 || img.channels() == 3 || img.channels() == 4));
+    const Size baseSize(2*img.cols, 2*img.rows);
+    const int numTilesX = (baseSize.width + this->tileSize_ - 1)/this->tileSize_;
+    const int numTilesY = (baseSize.height + this->tileSize_ - 1)/this->tileSize_;
+    const int numTiles = numTilesX*numTilesY;
+    std::mutex sinkLock;
+
+    if (this->options_.numThreads == 1) {
+        Buffers buffers;
+        for (int t = 0; t < numTiles; ++t) {
+            buildTile(img, plan(img.size(), t % numTilesX, t / numTilesX, numTilesX, numTilesY), buffers, sink, sinkLock);
+        }
+        this->peakMemory_ = buffers.bytes();
+        return;
+    }
+
+    //one task per thread, each pulling tiles with its own buffers, so memory stays at numThreads tiles.
+    TaskScheduler& scheduler = TaskScheduler::get(this->options_.numThreads);
+    const int numWorkers = std::min(scheduler.numThreads(), numTiles);
+    std::vector<Buffers> buffers(numWorkers);
+    std::atomic<int> nextTile{0};
+    TaskGraph graph;
+    for (int w = 0; w < numWorkers; ++w) {
+        graph.add([&, w]{
+            for (int t = nextTile++; t < numTiles; t = nextTile++) {
+                buildTile(img, plan(img.size(), t % numTilesX, t / numTilesX, numTilesX, numTilesY), buffers[w], sink, sinkLock);
+            }
+        });
+    }
+    graph.run(scheduler);
+    this->peakMemory_ = 0;
+    for (const Buffers& b : buffers) {
+        this->peakMemory_ += b.bytes();
+    }
+}
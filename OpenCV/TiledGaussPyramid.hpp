@@ -0,0 +1,63 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include "GaussPyramid.hpp"
+
+using namespace cv;
+
+//a finished piece of one level of a tiled build.
+struct PyramidTile
+{
+    int octave;
+    int level;
+    bool diff;          //a DoG level, otherwise a gaussian level.
+    Rect rect;          //where the tile goes in its octave.
+    Mat image;          //rect.size(). A view into the builder's buffers, copy it to keep it past the callback.
+};
+typedef std::function<void(const PyramidTile&)> PyramidTileSink;
+
+//Builds the same pyramid as GaussPyramid (bit for bit, in every precision mode) one tile at a time, for images whose
+//pyramid doesn't fit in memory. Nothing image sized is ever allocated: a tile is built from the input up through
+//every octave with halos wide enough for every blur & downsample on the way, and its levels are handed to a sink
+//(a callback, or a PyramidFileWriter to end up with a cache file).
+//Memory is bounded by the tile size, the halos grow with the kernel radii, so tiles should be well above the largest radius.
+class TiledGaussPyramid
+{
+    public:
+        //tileSize is in octave 0 pixels (the 2x upsampled input), rounded up to a multiple of 2^(numOctaves-1) so that tile
+        //origins are even in every octave, i.e. octave o gets tiles of tileSize>>o.
+        TiledGaussPyramid(int numOctaves, float sigma, int tileSize = 1024, const PyramidOptions& options = PyramidOptions());
+        //numThreads != 1 builds tiles in parallel, each with its own buffers. The sink is then called from several threads,
+        //one call at a time, in no particular order.
+        void build(const Mat& img, const PyramidTileSink& sink);
+        int numOctaves() const { return this->numOctaves_; }
+        int numLevels() const { return this->numImages_; }
+        int tileSize() const { return this->tileSize_; }
+        const ScaleSpace& scaleSpace() const { return this->scales_; }
+        PyramidPrecision precision() const { return this->options_.precision; }
+        //bytes of tile buffers held by the last build.
+        size_t peakMemory() const { return this->peakMemory_; }
+    private:
+        //what one tile needs: the rect of every level to compute (output plus halos), and the output rect of every octave.
+        struct Plan {
+            Rect input, base;
+            std::vector<std::vector<Rect>> levels;
+            std::vector<Rect> output;
+        };
+        struct Buffers {
+            Mat gray, input, base, diff;
+            std::vector<std::vector<Mat>> levels;
+            size_t bytes() const;
+        };
+        Plan plan(Size inputSize, int tx, int ty, int numTilesX, int numTilesY) const;
+        void buildTile(const Mat& img, const Plan& plan, Buffers& buffers, const PyramidTileSink& sink, std::mutex& sinkLock) const;
+        int numOctaves_ = 0;
+        int numImages_ = 0;
+        int tileSize_ = 0;
+        const ScaleSpace& scales_;
+        PyramidOptions options_;
+        size_t peakMemory_ = 0;
+};
@@ -0,0 +1,171 @@
+#include "Trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <iomanip>
+
+//a TraceEvent as the ring stores it. collect() reads slots the writer may be overwriting at that moment, so every
+//field is a relaxed atomic: a torn copy is then only wrong, not undefined, and collect() drops it.
+struct TraceSlot
+{
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> start{0};
+    std::atomic<uint64_t> duration{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<int32_t> level{-1};
+};
+
+//a ring with a single writer, its thread. head only ever grows, event i lives in events[i % bufferSize].
+//clear() can't touch head (the writer owns it), it moves tail up instead.
+struct TraceBuffer
+{
+    std::unique_ptr<TraceSlot[]> events{new TraceSlot[Trace::bufferSize]};
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};
+    uint32_t thread = 0;
+};
+
+//the rings outlive their threads (pool workers come & go), so they're owned here.
+static std::mutex& registryLock() {
+    static std::mutex lock;
+    return lock;
+}
+
+static std::vector<std::shared_ptr<TraceBuffer>>& registry() {
+    static std::vector<std::shared_ptr<TraceBuffer>> buffers;
+    return buffers;
+}
+
+static TraceBuffer& threadBuffer() {
+    thread_local std::shared_ptr<TraceBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<TraceBuffer>();
+        std::lock_guard<std::mutex> guard(registryLock());
+        buffer->thread = (uint32_t)registry().size();
+        registry().push_back(buffer);
+    }
+    return *buffer;
+}
+
+uint64_t Trace::now() {
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Trace::record(const char* name, uint64_t start, uint64_t end, uint64_t bytes, int level) {
+    TraceBuffer& buffer = threadBuffer();
+    const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    //pairs with the acquire fence in collect(): a reader that sees any of the stores below also sees head, so it
+    //knows this slot is being overwritten. (Only a compiler barrier on x86.)
+    std::atomic_thread_fence(std::memory_order_release);
+    TraceSlot& slot = buffer.events[head & (bufferSize - 1)];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(end - start, std::memory_order_relaxed);
+    slot.bytes.store(bytes, std::memory_order_relaxed);
+    slot.level.store(level, std::memory_order_relaxed);
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+std::vector<TraceEvent> Trace::collect() {
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> guard(registryLock());
+        buffers = registry();
+    }
+    std::vector<TraceEvent> events;
+    for (const std::shared_ptr<TraceBuffer>& buffer : buffers) {
+        const uint64_t head = buffer->head.load(std::memory_order_acquire);
+        const uint64_t first = std::max(buffer->tail.load(std::memory_order_relaxed), head > bufferSize ? head - bufferSize : 0);
+        const size_t offset = events.size();
+        for (uint64_t i = first; i < head; ++i) {
+            const TraceSlot& slot = buffer->events[i & (bufferSize - 1)];
+            events.push_back(TraceEvent{slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed),
+                                        slot.duration.load(std::memory_order_relaxed), slot.bytes.load(std::memory_order_relaxed),
+                                        slot.level.load(std::memory_order_relaxed), buffer->thread});
+        }
+        //whatever the writer got to in the meantime (and the event it may be writing now) may have overwritten
+        //the oldest events we copied. The fence makes head at least as new as any store we copied from.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t after = buffer->head.load(std::memory_order_relaxed);
+        if (after >= first + bufferSize) {
+            const uint64_t overwritten = std::min(after - bufferSize + 1, head) - first;
+            events.erase(events.begin() + offset, events.begin() + offset + overwritten);
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.start < b.start; });
+    return events;
+}
+
+void Trace::clear() {
+    std::lock_guard<std::mutex> guard(registryLock());
+    for (const std::shared_ptr<TraceBuffer>& buffer : registry()) {
+        buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+bool Trace::writeChromeTrace(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    const std::vector<TraceEvent> events = collect();
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const TraceEvent& e = events[i];
+        file << "{\"name\": \"" << e.name << "\", \"cat\": \"slam\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.thread
+             << ", \"ts\": " << e.start/1e3 << ", \"dur\": " << e.duration/1e3
+             << ", \"args\": {\"bytes\": " << e.bytes << ", \"level\": " << e.level << "}}"
+             << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    file << "]}\n";
+    return bool(file);
+}
+
+std::string Trace::summary() {
+    struct Stage {
+        uint64_t calls = 0, total = 0, max = 0, bytes = 0;
+    };
+    const std::vector<TraceEvent> events = collect();
+    std::map<std::string, Stage> stages;
+    uint64_t begin = UINT64_MAX, end = 0;
+    for (const TraceEvent& e : events) {
+        std::string name = e.name;
+        if (e.level >= 0) {
+            name += "[" + std::to_string(e.level) + "]";
+        }
+        Stage& stage = stages[name];
+        ++stage.calls;
+        stage.total += e.duration;
+        stage.max = std::max(stage.max, e.duration);
+        stage.bytes += e.bytes;
+        begin = std::min(begin, e.start);
+        end = std::max(end, e.start + e.duration);
+    }
+    std::vector<std::pair<std::string, Stage>> sorted(stages.begin(), stages.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second.total > b.second.total; });
+
+    //stages nest (a frame holds its blurs) & threads overlap, so the shares are of the traced wall time & don't add up to 100%.
+    const double wall = end > begin ? double(end - begin) : 1.0;
+    std::ostringstream out;
+    out << std::fixed;
+    out << std::setw(12) << "total ms" << std::setw(9) << "time%" << std::setw(9) << "calls" << std::setw(12) << "mean us"
+        << std::setw(12) << "max us" << std::setw(10) << "MB" << std::setw(9) << "GB/s" << "  stage\n";
+    for (const auto& [name, stage] : sorted) {
+        out << std::setprecision(3) << std::setw(12) << stage.total/1e6
+            << std::setprecision(1) << std::setw(9) << 100.0*stage.total/wall
+            << std::setw(9) << stage.calls
+            << std::setprecision(2) << std::setw(12) << stage.total/1e3/stage.calls
+            << std::setw(12) << stage.max/1e3
+            << std::setprecision(1) << std::setw(10) << stage.bytes/1e6
+            << std::setprecision(2) << std::setw(9) << (stage.total ? double(stage.bytes)/stage.total : 0.0)
+            << "  " << name << "\n";
+    }
+    out << events.size() << " events over " << std::setprecision(3) << wall/1e6 << " ms\n";
+    return out.str();
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Stage timings of the hot paths (GaussPyramid, ScaleSpace, Rotation), to see where a frame's time goes.
+//
+//Build with -DSLAM_TRACE to compile the hooks in, otherwise TRACE_SCOPE expands to nothing and costs nothing.
+//Compiled in, recording is still off until Trace::setEnabled(true), and costs one relaxed load per hook while off.
+//
+//Every thread records into its own ring of Trace::bufferSize events, with no locks & no allocation after its first
+//event: when a ring is full the oldest events are overwritten. Export with writeChromeTrace() (chrome://tracing or
+//ui.perfetto.dev) or summary(), ideally between frames: collecting while threads record is safe, but drops whatever
+//got overwritten meanwhile.
+//benchmark_suite --trace FILE does this for a whole run, see Benchmarks/benchmark_suite.cpp.
+struct TraceEvent
+{
+    const char* name;           //a string literal, only the pointer is kept.
+    uint64_t start;             //ns since the first Trace::now().
+    uint64_t duration;          //ns
+    uint64_t bytes;             //memory read + written by the stage (estimated), 0 if not counted.
+    int32_t level;              //the pyramid level, -1 if it doesn't apply.
+    uint32_t thread;            //small id, in the order threads first recorded.
+};
+
+class Trace
+{
+    public:
+        static constexpr size_t bufferSize = size_t(1) << 16;       //events per thread, a power of 2.
+        static void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+        static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+        static uint64_t now();
+        static void record(const char* name, uint64_t start, uint64_t end, uint64_t bytes, int level);
+        //every event still in the rings, sorted by start.
+        static std::vector<TraceEvent> collect();
+        //forget everything recorded so far.
+        static void clear();
+        //the Chrome trace event format, one complete ("X") event per stage.
+        static bool writeChromeTrace(const std::string& path);
+        //per stage (& level): calls, total, share of the traced time, mean, max & bandwidth, slowest first.
+        static std::string summary();
+    private:
+        static inline std::atomic<bool> enabled_{false};
+};
+
+//times its own lifetime. Use it through TRACE_SCOPE so it compiles out.
+class TraceScope
+{
+    public:
+        explicit TraceScope(const char* name, uint64_t bytes = 0, int level = -1)
+            : name_{name}, bytes_{bytes}, level_{level}, active_{Trace::enabled()}, start_{active_ ? Trace::now() : 0} {}
+        ~TraceScope() {
+            if (this->active_) {
+                Trace::record(this->name_, this->start_, Trace::now(), this->bytes_, this->level_);
+            }
+        }
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+    private:
+        const char* name_;
+        uint64_t bytes_;
+        int level_;
+        bool active_;
+        uint64_t start_;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#ifdef SLAM_TRACE
+//TRACE_SCOPE(name [, bytes [, level]]): time the rest of the enclosing block. The arguments aren't evaluated when compiled out.
+#define TRACE_SCOPE(...) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(__VA_ARGS__)
+#else
+#define TRACE_SCOPE(...) ((void)0)
+#endif
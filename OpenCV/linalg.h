@@ -0,0 +1,250 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <cmath>
+#include <initializer_list>
+#include <type_traits>
+
+//Small fixed size matrices & vectors for 2D/3D geometry. cv::Mat allocates for every product (see linear_algebra_opencv.cpp:
+//'Never use OpenCV's cv::Mat for 3D geometry computations, it is extremely slow!'), these live on the stack, every
+//operation is constexpr & inlined, and nothing ever allocates.
+//Row major like OpenCV: a<row><col> is data[row*M + col]. A vector is a column, Vec<N,T> = Mat<N,1,T>, so the shapes follow
+//the same rules as in OpenCV: a.t()*b is a 1x1 matrix (the dot product), a*b.t() an NxN one (the outer product).
+namespace SLAM {
+namespace linalg {
+    template<int N, int M, typename T>
+    struct Mat
+    {
+        static_assert(N > 0 && M > 0, "empty matrix");
+        static constexpr int rows = N;
+        static constexpr int cols = M;
+        T data[N*M] = {};
+
+        constexpr Mat() = default;
+        //row major values, missing ones are 0: Mat<2,2,float>{1, 2, 3, 4}.
+        constexpr Mat(std::initializer_list<T> values) {
+            int i = 0;
+            for (T v : values) {
+                if (i < N*M) {
+                    this->data[i++] = v;
+                }
+            }
+        }
+        //cv::Matx & cv::Vec, in both directions.
+        constexpr Mat(const cv::Matx<T, N, M>& m) {
+            for (int i = 0; i < N*M; ++i) {
+                this->data[i] = m.val[i];
+            }
+        }
+        operator cv::Matx<T, N, M>() const { return cv::Matx<T, N, M>(this->data); }
+        template<int n = N, typename = std::enable_if_t<M == 1 && n == N>>
+        operator cv::Vec<T, N>() const { return cv::Vec<T, N>(cv::Matx<T, N, 1>(this->data)); }
+
+        static constexpr Mat zeros() { return Mat(); }
+        static constexpr Mat eye() {
+            Mat m;
+            for (int i = 0; i < (N < M ? N : M); ++i) {
+                m(i, i) = T(1);
+            }
+            return m;
+        }
+
+        constexpr T& operator()(int r, int c) { return this->data[r*M + c]; }
+        constexpr const T& operator()(int r, int c) const { return this->data[r*M + c]; }
+        //element i of a vector (either shape), or of the row major data.
+        constexpr T& operator[](int i) { return this->data[i]; }
+        constexpr const T& operator[](int i) const { return this->data[i]; }
+
+        constexpr Mat<M, N, T> t() const {
+            Mat<M, N, T> r;
+            for (int i = 0; i < N; ++i) {
+                for (int j = 0; j < M; ++j) {
+                    r(j, i) = (*this)(i, j);
+                }
+            }
+            return r;
+        }
+
+        constexpr Mat& operator+=(const Mat& b) { for (int i = 0; i < N*M; ++i) this->data[i] += b.data[i]; return *this; }
+        constexpr Mat& operator-=(const Mat& b) { for (int i = 0; i < N*M; ++i) this->data[i] -= b.data[i]; return *this; }
+        constexpr Mat& operator*=(T s) { for (int i = 0; i < N*M; ++i) this->data[i] *= s; return *this; }
+        friend constexpr Mat operator+(Mat a, const Mat& b) { return a += b; }
+        friend constexpr Mat operator-(Mat a, const Mat& b) { return a -= b; }
+        friend constexpr Mat operator*(Mat a, T s) { return a *= s; }
+        friend constexpr Mat operator*(T s, Mat a) { return a *= s; }
+        friend constexpr bool operator==(const Mat& a, const Mat& b) {
+            for (int i = 0; i < N*M; ++i) {
+                if (a.data[i] != b.data[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        friend constexpr bool operator!=(const Mat& a, const Mat& b) { return !(a == b); }
+    };
+
+    template<int N, typename T>
+    using Vec = Mat<N, 1, T>;
+
+    typedef Mat<2, 2, float> Mat22f;
+    typedef Mat<2, 3, float> Mat23f;
+    typedef Mat<3, 3, float> Mat33f;
+    typedef Mat<2, 2, double> Mat22d;
+    typedef Mat<2, 3, double> Mat23d;
+    typedef Mat<3, 3, double> Mat33d;
+    typedef Vec<2, float> Vec2f;
+    typedef Vec<3, float> Vec3f;
+    typedef Vec<2, double> Vec2d;
+    typedef Vec<3, double> Vec3d;
+
+    //matrix * matrix, which covers matrix * vector & both vector products.
+    template<int N, int K, int M, typename T>
+    constexpr Mat<N, M, T> operator*(const Mat<N, K, T>& a, const Mat<K, M, T>& b) {
+        Mat<N, M, T> r;
+        for (int i = 0; i < N; ++i) {
+            for (int j = 0; j < M; ++j) {
+                T sum = T(0);
+                for (int k = 0; k < K; ++k) {
+                    sum += a(i, k)*b(k, j);
+                }
+                r(i, j) = sum;
+            }
+        }
+        return r;
+    }
+
+    template<int N, typename T>
+    constexpr T dot(const Vec<N, T>& a, const Vec<N, T>& b) {
+        T sum = T(0);
+        for (int i = 0; i < N; ++i) {
+            sum += a[i]*b[i];
+        }
+        return sum;
+    }
+
+    template<int N, int M, typename T>
+    constexpr Mat<N, M, T> outer(const Vec<N, T>& a, const Vec<M, T>& b) { return a*b.t(); }
+
+    template<typename T>
+    constexpr Vec<3, T> cross(const Vec<3, T>& a, const Vec<3, T>& b) {
+        return Vec<3, T>{a[1]*b[2] - a[2]*b[1], a[2]*b[0] - a[0]*b[2], a[0]*b[1] - a[1]*b[0]};
+    }
+
+    //2x2 & 3x3 in closed form, larger ones by elimination with partial pivoting.
+    template<int N, typename T>
+    constexpr T determinant(const Mat<N, N, T>& a) {
+        if constexpr (N == 1) {
+            return a(0, 0);
+        }
+        else if constexpr (N == 2) {
+            return a(0, 0)*a(1, 1) - a(0, 1)*a(1, 0);
+        }
+        else if constexpr (N == 3) {
+            return a(0, 0)*(a(1, 1)*a(2, 2) - a(1, 2)*a(2, 1))
+                 - a(0, 1)*(a(1, 0)*a(2, 2) - a(1, 2)*a(2, 0))
+                 + a(0, 2)*(a(1, 0)*a(2, 1) - a(1, 1)*a(2, 0));
+        }
+        else {
+            Mat<N, N, T> m = a;
+            T det = T(1);
+            for (int c = 0; c < N; ++c) {
+                int p = c;
+                for (int r = c + 1; r < N; ++r) {
+                    if ((m(r, c) < 0 ? -m(r, c) : m(r, c)) > (m(p, c) < 0 ? -m(p, c) : m(p, c))) {
+                        p = r;
+                    }
+                }
+                if (m(p, c) == T(0)) {
+                    return T(0);
+                }
+                if (p != c) {
+                    for (int j = 0; j < N; ++j) {
+                        const T tmp = m(c, j); m(c, j) = m(p, j); m(p, j) = tmp;
+                    }
+                    det = -det;
+                }
+                det *= m(c, c);
+                for (int r = c + 1; r < N; ++r) {
+                    const T f = m(r, c)/m(c, c);
+                    for (int j = c; j < N; ++j) {
+                        m(r, j) -= f*m(c, j);
+                    }
+                }
+            }
+            return det;
+        }
+    }
+
+    //like cv::Mat::inv(), a singular matrix gives all zeros.
+    template<int N, typename T>
+    constexpr Mat<N, N, T> inverse(const Mat<N, N, T>& a) {
+        const T det = determinant(a);
+        if (det == T(0)) {
+            return Mat<N, N, T>();
+        }
+        if constexpr (N == 1) {
+            return Mat<1, 1, T>{T(1)/det};
+        }
+        else if constexpr (N == 2) {
+            return Mat<2, 2, T>{a(1, 1), -a(0, 1), -a(1, 0), a(0, 0)}*(T(1)/det);
+        }
+        else if constexpr (N == 3) {
+            //the transposed cofactors.
+            Mat<3, 3, T> r;
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    const int r0 = (j + 1) % 3, r1 = (j + 2) % 3, c0 = (i + 1) % 3, c1 = (i + 2) % 3;
+                    r(i, j) = (a(r0, c0)*a(r1, c1) - a(r0, c1)*a(r1, c0))/det;
+                }
+            }
+            return r;
+        }
+        else {
+            //gauss jordan on [a | I].
+            Mat<N, N, T> m = a;
+            Mat<N, N, T> r = Mat<N, N, T>::eye();
+            for (int c = 0; c < N; ++c) {
+                int p = c;
+                for (int row = c + 1; row < N; ++row) {
+                    if ((m(row, c) < 0 ? -m(row, c) : m(row, c)) > (m(p, c) < 0 ? -m(p, c) : m(p, c))) {
+                        p = row;
+                    }
+                }
+                for (int j = 0; j < N; ++j) {
+                    T tmp = m(c, j); m(c, j) = m(p, j); m(p, j) = tmp;
+                    tmp = r(c, j); r(c, j) = r(p, j); r(p, j) = tmp;
+                }
+                const T pivot = m(c, c);
+                for (int j = 0; j < N; ++j) {
+                    m(c, j) /= pivot;
+                    r(c, j) /= pivot;
+                }
+                for (int row = 0; row < N; ++row) {
+                    if (row != c) {
+                        const T f = m(row, c);
+                        for (int j = 0; j < N; ++j) {
+                            m(row, j) -= f*m(c, j);
+                            r(row, j) -= f*r(c, j);
+                        }
+                    }
+                }
+            }
+            return r;
+        }
+    }
+
+    //a 2x3 affine transform of a point, i.e. M * (x, y, 1).
+    template<typename T>
+    constexpr Vec<2, T> transformPoint(const Mat<2, 3, T>& m, T x, T y) {
+        return Vec<2, T>{m(0, 0)*x + m(0, 1)*y + m(0, 2), m(1, 0)*x + m(1, 1)*y + m(1, 2)};
+    }
+
+    //the matrix of cv::getRotationMatrix2D (angle in degrees, counter clockwise), without the cv::Mat.
+    inline Mat<2, 3, double> rotationMatrix2D(const cv::Point2f& center, double angle, double scale) {
+        const double theta = angle*CV_PI/180.0;
+        const double alpha = std::cos(theta)*scale;
+        const double beta = std::sin(theta)*scale;
+        return Mat<2, 3, double>{alpha, beta, (1 - alpha)*center.x - beta*center.y,
+                                 -beta, alpha, beta*center.x + (1 - alpha)*center.y};
+    }
+} //namespace linalg
+} //namespace SLAM
@@ -6,6 +6,7 @@
 #include <vector>
 #include <algorithm>
 #include <opencv2/core/types.hpp>
+#include "linalg.h"
 
 using namespace cv;
 
@@ -115,5 +116,53 @@ int main() {
     E = D*A;
     std::cout << "mat*vec --> Vector (E): " << std::endl << E << std::endl;
 
+
+    //7. the same operations with SLAM::linalg: fixed size, on the stack, no allocation.
+    namespace la = SLAM::linalg;
+    la::Vec3f la_a{1.0f, 2.0f, 3.0f};
+    la::Vec3f la_b{3.0f, 5.0f, 7.0f};                     //B was copied from b before b[2] changed.
+    la::Mat<1,3,float> la_B = la_b.t();                     //1. vector transpose
+    la::Mat<1,1,float> la_C = la_B*la_a;                    //2. vec*vec --> Scalar
+    la::Mat33f la_D = la::outer(la_a, la_b);                //3. vec*vec --> Matrix, same as la_a*la_B
+    la::Mat33f la_D_transpose = la_D.t();                   //4. Matrix transpose
+    la::Mat33f la_D_inverse = la::inverse(la_D);            //5. Matrix inverse (D is singular, so all zeros like Mat::inv)
+    float la_det = la::determinant(la_D);                   //5.a determinant
+    la::Vec3f la_E = la_D*la_a;                             //6. matrix*vec --> vector
+    std::cout << "linalg: C " << la_C[0] << ", D " << Matx33f(la_D) << ", D^T " << Matx33f(la_D_transpose)
+              << ", D^-1 " << Matx33f(la_D_inverse) << ", det " << la_det << ", E " << Vec3f(la_E) << std::endl;
+
+    //everything is constexpr, so it can even be done at compile time.
+    constexpr la::Mat22d rot90{0.0, -1.0, 1.0, 0.0};
+    static_assert(la::determinant(rot90) == 1.0, "a rotation keeps areas");
+    static_assert(la::inverse(rot90) == rot90.t(), "the inverse of a rotation is its transpose");
+
+
+    //8. how much the allocations cost: mat*vec a million times.
+    const int times = 1000000;
+    Matx33d Dd(D.ptr<float>(0)[0], D.ptr<float>(0)[1], D.ptr<float>(0)[2], D.ptr<float>(1)[0], D.ptr<float>(1)[1], D.ptr<float>(1)[2], D.ptr<float>(2)[0], D.ptr<float>(2)[1], D.ptr<float>(2)[2]);
+    Mat D64 = Mat(Dd);
+    Mat v64 = Mat(Vec3d(1.0, 2.0, 3.0));
+    la::Mat33d la_Dd = Dd;
+    la::Vec3d la_v{1.0, 2.0, 3.0};
+    double sum = 0;
+
+    double t = (double)getTickCount();
+    for (int i = 0; i < times; i++) {
+        v64.at<double>(0) = i;
+        Mat r = D64*v64;
+        sum += r.at<double>(0);
+    }
+    t = 1000 * ((double)getTickCount() - t) / getTickFrequency();
+    std::cout << "cv::Mat mat*vec x" << times << ": " << t << " milliseconds." << std::endl;
+
+    t = (double)getTickCount();
+    for (int i = 0; i < times; i++) {
+        la_v[0] = i;
+        la::Vec3d r = la_Dd*la_v;
+        sum += r[0];
+    }
+    t = 1000 * ((double)getTickCount() - t) / getTickFrequency();
+    std::cout << "linalg mat*vec x" << times << ": " << t << " milliseconds. (" << sum << ")" << std::endl;
+
     return 0;
 }
\ No newline at end of file
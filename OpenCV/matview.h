@@ -0,0 +1,169 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+using namespace cv;
+
+//A typed view of the pixels of a 2D cv::Mat: the first element, the bytes from one row to the next & the channels, read out
+//of the Mat once. Mat::at<T>(y, x) & Mat::ptr<T>(y) go back to the Mat on every call (debug asserts, and step & data are
+//loaded again after every store through a uchar*), an access here is data + y*step + x*channels, which stays in registers
+//for a whole loop. T is the depth (float for 32FC3) or a cv::Vec of it (Vec3f for 32FC3, then channels() is 1).
+//The view owns nothing, the Mat has to outlive it like a Mat ROI. And like cv::Mat_, the view of a const Mat can still
+//write, the constness of a Mat is shallow: use MatView<const T> for a read only one.
+//  view[y]             the row pointer
+//  view(y, x, c)       element c of pixel (x, y)
+//  view(rect)          the pixels inside rect, like Mat(m, rect)
+//  view.row(y)         a row, cols * channels elements in a row: plain pointers, so loops over it vectorize
+//  view.eachRow()      range-for over the rows
+//  begin() / end()     every element row major, stepping over the padding between rows, for STL algorithms
+namespace SLAM {
+    template<typename T>
+    class MatView {
+        //the pixels as bytes, with the constness of T.
+        using Byte = std::conditional_t<std::is_const<T>::value, const uchar, uchar>;
+        public:
+            using value_type = std::remove_cv_t<T>;
+
+            class Row {
+                public:
+                    Row(T* first, int size) : first_{first}, size_{size} {}
+                    T* begin() const { return this->first_; }
+                    T* end() const { return this->first_ + this->size_; }
+                    T* data() const { return this->first_; }
+                    int size() const { return this->size_; }
+                    T& operator[](int i) const { return this->first_[i]; }
+                private:
+                    T* first_;
+                    int size_;
+            };
+
+            //the rows top to bottom. Random access with a Row by value for the reference, like the iterator of std::vector<bool>.
+            class RowIterator {
+                public:
+                    using iterator_category = std::random_access_iterator_tag;
+                    using value_type = Row;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = void;
+                    using reference = Row;
+
+                    RowIterator() = default;
+                    RowIterator(Byte* row, size_t step, int size) : row_{row}, step_{step}, size_{size} {}
+                    Row operator*() const { return Row(reinterpret_cast<T*>(this->row_), this->size_); }
+                    Row operator[](difference_type n) const { return *(*this + n); }
+                    RowIterator& operator++() { this->row_ += this->step_; return *this; }
+                    RowIterator operator++(int) { RowIterator it = *this; ++*this; return it; }
+                    RowIterator& operator--() { this->row_ -= this->step_; return *this; }
+                    RowIterator operator--(int) { RowIterator it = *this; --*this; return it; }
+                    RowIterator& operator+=(difference_type n) { this->row_ += n*difference_type(this->step_); return *this; }
+                    RowIterator& operator-=(difference_type n) { this->row_ -= n*difference_type(this->step_); return *this; }
+                    friend RowIterator operator+(RowIterator it, difference_type n) { return it += n; }
+                    friend RowIterator operator+(difference_type n, RowIterator it) { return it += n; }
+                    friend RowIterator operator-(RowIterator it, difference_type n) { return it -= n; }
+                    friend difference_type operator-(const RowIterator& a, const RowIterator& b) {
+                        return a.step_ ? (a.row_ - b.row_)/difference_type(a.step_) : 0;
+                    }
+                    friend bool operator==(const RowIterator& a, const RowIterator& b) { return a.row_ == b.row_; }
+                    friend bool operator!=(const RowIterator& a, const RowIterator& b) { return a.row_ != b.row_; }
+                    friend bool operator<(const RowIterator& a, const RowIterator& b) { return a.row_ < b.row_; }
+                    friend bool operator>(const RowIterator& a, const RowIterator& b) { return a.row_ > b.row_; }
+                    friend bool operator<=(const RowIterator& a, const RowIterator& b) { return a.row_ <= b.row_; }
+                    friend bool operator>=(const RowIterator& a, const RowIterator& b) { return a.row_ >= b.row_; }
+                private:
+                    Byte* row_ = nullptr;
+                    size_t step_ = 0;
+                    int size_ = 0;
+            };
+
+            struct Rows {
+                RowIterator first, last;
+                RowIterator begin() const { return this->first; }
+                RowIterator end() const { return this->last; }
+                std::ptrdiff_t size() const { return this->last - this->first; }
+            };
+
+            //every element row major. Inside a row it's a pointer increment, the jump over the padding costs a compare per
+            //element: loops over row() are the fast way through a view with padding, this is for STL algorithms.
+            class Iterator {
+                public:
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type = MatView::value_type;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = T*;
+                    using reference = T&;
+
+                    Iterator() = default;
+                    Iterator(T* p, T* rowEnd, size_t step, int size) : p_{p}, rowEnd_{rowEnd}, step_{step}, size_{size} {}
+                    T& operator*() const { return *this->p_; }
+                    T* operator->() const { return this->p_; }
+                    Iterator& operator++() {
+                        if (++this->p_ == this->rowEnd_) {
+                            this->rowEnd_ = reinterpret_cast<T*>(reinterpret_cast<Byte*>(this->rowEnd_) + this->step_);
+                            this->p_ = this->rowEnd_ - this->size_;
+                        }
+                        return *this;
+                    }
+                    Iterator operator++(int) { Iterator it = *this; ++*this; return it; }
+                    friend bool operator==(const Iterator& a, const Iterator& b) { return a.p_ == b.p_; }
+                    friend bool operator!=(const Iterator& a, const Iterator& b) { return a.p_ != b.p_; }
+                private:
+                    T* p_ = nullptr;
+                    T* rowEnd_ = nullptr;
+                    size_t step_ = 0;
+                    int size_ = 0;
+            };
+
+            MatView() = default;
+            //step in bytes, channels counts Ts per pixel.
+            MatView(T* data, int rows, int cols, size_t step, int channels = 1) : data_{data}, rows_{rows}, cols_{cols}, channels_{channels}, step_{step} {}
+            explicit MatView(const Mat& m) : MatView(reinterpret_cast<T*>(m.data), m.rows, m.cols, m.step, m.channels()/DataType<value_type>::channels) {
+                CV_Assert(m.dims <= 2 && (m.empty() || (m.depth() == DataType<value_type>::depth && m.channels() % DataType<value_type>::channels == 0)));
+            }
+            //a read only view of a writable one.
+            template<typename U, typename = std::enable_if_t<std::is_same<const U, T>::value>>
+            MatView(const MatView<U>& other) : MatView(other.data(), other.rows(), other.cols(), other.step(), other.channels()) {}
+
+            T* data() const { return this->data_; }
+            int rows() const { return this->rows_; }
+            int cols() const { return this->cols_; }
+            int channels() const { return this->channels_; }
+            size_t step() const { return this->step_; }
+            Size size() const { return Size(this->cols_, this->rows_); }
+            bool empty() const { return this->rows_ == 0 || this->cols_ == 0; }
+            //no padding between the rows, so the whole view is one run of rows * cols * channels elements.
+            bool isContinuous() const { return this->rows_ <= 1 || this->step_ == size_t(this->cols_)*this->channels_*sizeof(T); }
+            bool contains(int x, int y) const { return (unsigned)x < (unsigned)this->cols_ && (unsigned)y < (unsigned)this->rows_; }
+
+            T* operator[](int y) const { return reinterpret_cast<T*>(reinterpret_cast<Byte*>(this->data_) + std::ptrdiff_t(y)*this->step_); }
+            T* ptr(int y, int x) const { return (*this)[y] + x*this->channels_; }
+            T& operator()(int y, int x, int c = 0) const { return (*this)[y][x*this->channels_ + c]; }
+            MatView operator()(const Rect& rect) const {
+                CV_Assert(rect.x >= 0 && rect.y >= 0 && rect.width >= 0 && rect.height >= 0 && rect.x + rect.width <= this->cols_ && rect.y + rect.height <= this->rows_);
+                return MatView(this->ptr(rect.y, rect.x), rect.height, rect.width, this->step_, this->channels_);
+            }
+
+            Row row(int y) const { return Row((*this)[y], this->cols_*this->channels_); }
+            Rows eachRow() const {
+                const RowIterator first(reinterpret_cast<Byte*>(this->data_), this->step_, this->cols_*this->channels_);
+                return Rows{first, first + this->rows_};
+            }
+            Iterator begin() const {
+                if (this->empty()) {
+                    return this->end();
+                }
+                const int size = this->cols_*this->channels_;
+                return Iterator(this->data_, this->data_ + size, this->step_, size);
+            }
+            Iterator end() const {
+                T* last = (*this)[this->rows_];
+                return Iterator(last, last, this->step_, this->cols_*this->channels_);
+            }
+        private:
+            T* data_ = nullptr;
+            int rows_ = 0;
+            int cols_ = 0;
+            int channels_ = 1;
+            size_t step_ = 0;
+    };
+} //namespace SLAM
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <opencv2/highgui.hpp>
+#include "GaussPyramid.hpp"
+
+using namespace std;
+
+/*
+    Compare the precision modes of GaussPyramid:
+    1. how long a build takes & how much memory the pyramid takes
+    2. the largest difference of every gaussian & DoG level to the Float32 pyramid, against the documented bound
+    3. how many keypoints are found, against the Float32 pyramid
+*/
+
+std::string img_string = samples::findFile("blox.jpg");
+Mat img = imread(img_string, IMREAD_GRAYSCALE);
+const int numOctaves = 3;
+const float sigma = 1.6f;
+const int times = 20;
+
+//largest |a - b| over every level, with both pyramids converted to [0,1] units.
+static double maxError(const std::vector<Mat>& a, double scaleA, const std::vector<Mat>& b, double scaleB, int level) {
+    Mat fa, fb;
+    a[level].convertTo(fa, CV_32F, 1.0/scaleA);
+    b[level].convertTo(fb, CV_32F, 1.0/scaleB);
+    return norm(fa, fb, NORM_INF);
+}
+
+int main() {
+    const char* names[] = {"Float32", "Float16", "Fixed16"};
+    const PyramidPrecision precisions[] = {PyramidPrecision::Float32, PyramidPrecision::Float16, PyramidPrecision::Fixed16};
+
+    GaussPyramid reference(img, numOctaves, sigma);
+    KeypointArray referenceKeypoints;
+    reference.detectExtrema(referenceKeypoints);
+
+    for (int p = 0; p < 3; ++p) {
+        PyramidOptions options;
+        options.precision = precisions[p];
+        GaussPyramid pyramid(img, numOctaves, sigma, options);
+
+        double t = (double)getTickCount();
+        for (int i = 0; i < times; i++) {
+            pyramid.rebuild(img);
+        }
+        t = 1000 * ((double)getTickCount() - t) / getTickFrequency();
+        t /= times;
+        cout << names[p] << ": build " << t << " ms (averaged for " << times << " runs), "
+             << pyramid.memoryFootprint()/(1024.0*1024.0) << " MB" << endl;
+
+        //worst level, relative to its bound.
+        double gaussError = 0, diffError = 0;
+        bool withinBound = true;
+        for (int o = 0; o < numOctaves; ++o) {
+            for (int l = 0; l < numOctaves + 3; ++l) {
+                double e = maxError(pyramid.getBlurOctave(o), pyramid.valueScale(), reference.getBlurOctave(o), 1.0, l);
+                gaussError = std::max(gaussError, e);
+                withinBound = withinBound && e <= pyramid.levelErrorBound(o, l);
+            }
+            for (int l = 0; l < numOctaves + 2; ++l) {
+                double e = maxError(pyramid.getDiffOctave(o), pyramid.valueScale(), reference.getDiffOctave(o), 1.0, l);
+                diffError = std::max(diffError, e);
+                withinBound = withinBound && e <= pyramid.diffErrorBound(o, l);
+            }
+        }
+        const int top = numOctaves - 1;
+        cout << "    max gaussian error " << gaussError << " (bound at the top level " << pyramid.levelErrorBound(top, numOctaves + 2) << ")"
+             << ", max DoG error " << diffError << " (bound " << pyramid.diffErrorBound(top, numOctaves + 1) << ")"
+             << (withinBound ? "" : "  BOUND EXCEEDED") << endl;
+
+        KeypointArray keypoints;
+        t = (double)getTickCount();
+        pyramid.detectExtrema(keypoints);
+        t = 1000 * ((double)getTickCount() - t) / getTickFrequency();
+        cout << "    " << keypoints.size() << " keypoints (Float32: " << referenceKeypoints.size() << "), detection " << t << " ms" << endl;
+    }
+    return 0;
+}
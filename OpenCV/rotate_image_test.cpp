@@ -27,6 +27,7 @@ int pt_rotation = 0;
 int maxRotation = 360;
 
 //float angle_deg = 180.0f;       //rotating 180 degrees looks fine, but 90 absolutely destroys the image.
+//(no longer: multiples of 90 are now plain pixel copies, see Rotation::isQuarterTurn.)
 int rows = img.rows;
 int cols = img.cols;
 const Point2i origin(0, 0);
@@ -57,15 +58,28 @@ int main() {
     const int times = 100;
     double t = (double)getTickCount();
 
-    /*
-    for (int i = 0; i < times; i++) {
-        //rotate matrix here
-        rotate_mat_CCW(img, center, angles);
+    //0. the whole image, nearest & bilinear, against warpAffine with the same mapping.
+    Point2f angles45 = SLAM::Rotation::cos_sin_of_angle(45.0f);
+    Mat rotated;
+    for (int interpolation : {INTER_NEAREST, INTER_LINEAR}) {
+        t = (double)getTickCount();
+        for (int i = 0; i < times; i++) {
+            SLAM::Rotation::rotate(img, rotated, center, angles45, interpolation);
+        }
+        t = 1000 * ((double)getTickCount() - t) / getTickFrequency();
+        t /= times;
+        cout << "Time rotating image, " << (interpolation == INTER_NEAREST ? "nearest" : "bilinear") << " (averaged for " << times << " runs): " << t << " milliseconds." << endl;
+
+        //rotate() maps dst to src, so warpAffine gets the inverse map of the image rotated by -45 degrees.
+        Mat rotation_mat = getRotationMatrix2D(center, -45.0, 1.0);
+        t = (double)getTickCount();
+        for (int i = 0; i < times; i++) {
+            warpAffine(img, rotated, rotation_mat, img.size(), interpolation | WARP_INVERSE_MAP);
+        }
+        t = 1000 * ((double)getTickCount() - t) / getTickFrequency();
+        t /= times;
+        cout << "Time rotating image with warpAffine, " << (interpolation == INTER_NEAREST ? "nearest" : "bilinear") << " (averaged for " << times << " runs): " << t << " milliseconds." << endl;
     }
-    t = 1000 * ((double)getTickCount() - t) / getTickFrequency();
-    t /= times;
-    cout << "Time rotating image (averaged for " << times << " runs): " << t << " milliseconds." << endl;
-    */
 
 
     //1. Directly computes new rotated positions from previous positions
@@ -93,6 +107,24 @@ int main() {
     cout << "Time rotating 16x16 ROI with the double crop method (averaged for " << times << " runs): " << t << " milliseconds." << endl;
 
 
+    //3. many windows at once, e.g. one per keypoint, into a single preallocated patch image.
+    const int numWindows = 1000;
+    SLAM::RotatedWindowArray windows;
+    RNG rng(0);
+    for (int i = 0; i < numWindows; i++) {
+        windows.push_back(rng.uniform(0.0f, (float)cols), rng.uniform(0.0f, (float)rows), rng.uniform(0.0f, 360.0f), (float)windowSize);
+    }
+    Mat patches;
+    SLAM::Rotation::extractWindows(img, windows, windowSize, patches);
+    t = (double)getTickCount();
+    for (int i = 0; i < times; i++) {
+        SLAM::Rotation::extractWindows(img, windows, windowSize, patches);
+    }
+    t = 1000 * ((double)getTickCount() - t) / getTickFrequency();
+    t /= times;
+    cout << "Time extracting " << numWindows << " 16x16 ROIs in one batch (averaged for " << times << " runs): " << t << " milliseconds." << endl;
+
+
     namedWindow(window_name, WINDOW_AUTOSIZE);
     namedWindow(window_name2, WINDOW_AUTOSIZE);
 
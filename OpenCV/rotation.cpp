@@ -7,6 +7,10 @@ float Rotation::convertToRadians(float theta) {
 }
 
 const Point2f Rotation::cos_sin_of_angle(float theta, bool degrees) {
+    //orientations are mostly whole degrees, those are table loads.
+    if (degrees && theta == std::floor(theta) && std::abs(theta) < 1e6f) {
+        return trigLUT360.angles(TrigLUT<360>::bin(theta));
+    }
     float angle = 0;
     if (degrees) {
         angle = convertToRadians(theta);
@@ -49,56 +53,772 @@ Point2i Rotation::rotate_pt_CCW(const Point2i& pt, const Point2i& center, float
     return rot;
 }
 
+Transform Transform::affine(const linalg::Mat23f& m) {
+    Transform t;
+    t.kind_ = Kind::Affine;
+    t.matrix_ = linalg::Mat33f{m(0,0), m(0,1), m(0,2), m(1,0), m(1,1), m(1,2), 0.0f, 0.0f, 1.0f};
+    return t;
+}
+
+Transform Transform::rigid(const Point2f& angles, const Point2f& translation) {
+    Transform t;
+    t.kind_ = Kind::Rigid;
+    t.matrix_ = linalg::Mat33f{angles.x, -angles.y, translation.x, angles.y, angles.x, translation.y, 0.0f, 0.0f, 1.0f};
+    return t;
+}
+
+//c + R (p - c) = R p + (c - R c)
+Transform Transform::rotation(const Point2f& center, const Point2f& angles) {
+    return rigid(angles, center - Point2f(center.x*angles.x - center.y*angles.y, center.x*angles.y + center.y*angles.x));
+}
+
+Transform Transform::homography(const linalg::Mat33f& h) {
+    Transform t;
+    t.kind_ = Kind::Homography;
+    t.matrix_ = h;
+    return t;
+}
+
+Transform Transform::inverse() const {
+    Transform t;
+    t.kind_ = this->kind_;
+    const linalg::Mat33f& m = this->matrix_;
+    if (this->kind_ == Kind::Rigid) {
+        //R^T (p - t)
+        const float tx = -(m(0,0)*m(0,2) + m(1,0)*m(1,2));
+        const float ty = -(m(0,1)*m(0,2) + m(1,1)*m(1,2));
+        t.matrix_ = linalg::Mat33f{m(0,0), m(1,0), tx, m(0,1), m(1,1), ty, 0.0f, 0.0f, 1.0f};
+    }
+    else {
+        t.matrix_ = linalg::inverse(m);
+        if (this->kind_ == Kind::Affine) {
+            t.matrix_(2,0) = 0.0f;
+            t.matrix_(2,1) = 0.0f;
+            t.matrix_(2,2) = 1.0f;
+        }
+    }
+    return t;
+}
+
+Transform Transform::operator*(const Transform& other) const {
+    Transform t;
+    t.matrix_ = this->matrix_*other.matrix_;
+    if (this->kind_ == Kind::Homography || other.kind_ == Kind::Homography) {
+        t.kind_ = Kind::Homography;
+    }
+    else {
+        t.kind_ = this->kind_ == Kind::Rigid && other.kind_ == Kind::Rigid ? Kind::Rigid : Kind::Affine;
+    }
+    return t;
+}
+
+//every parallel loop of the module runs on the TaskScheduler pool, the same one rotateTiled & the pyramids use:
+//[0, n) in ranges of at least grain items, about 4 per worker so uneven ranges still balance, one task each.
+//A single range, or a call from a worker of the pool (run() would block it), runs on this thread.
+template<typename Fn>
+static void parallelRanges(int n, int grain, const Fn& fn) {
+    TaskScheduler& pool = TaskScheduler::get(0);
+    const int numRanges = std::min((n + grain - 1)/grain, 4*pool.numThreads());
+    if (numRanges <= 1 || pool.onWorker()) {
+        if (n > 0) {
+            fn(Range(0, n));
+        }
+        return;
+    }
+    TaskGraph graph;
+    for (int i = 0; i < numRanges; ++i) {
+        const Range range(int(int64_t(n)*i/numRanges), int(int64_t(n)*(i + 1)/numRanges));
+        graph.add([&fn, range]{ fn(range); });
+    }
+    graph.run(pool);
+}
+
+Point2f Transform::apply(const Point2f& pt) const {
+    float x = pt.x, y = pt.y;
+    apply(&x, &y, &x, &y, 1);
+    return Point2f(x, y);
+}
+
+//points [begin, end), a vector of points at a time & the tail one by one.
+static void applyAffine(const linalg::Mat33f& m, const float* srcX, const float* srcY, float* dstX, float* dstY, size_t begin, size_t end) {
+    size_t i = begin;
+#if CV_SIMD
+    const int lanes = v_float32::nlanes;
+    const v_float32 a = vx_setall_f32(m(0,0)), b = vx_setall_f32(m(0,1)), c = vx_setall_f32(m(0,2));
+    const v_float32 d = vx_setall_f32(m(1,0)), e = vx_setall_f32(m(1,1)), f = vx_setall_f32(m(1,2));
+    for (; i + lanes <= end; i += lanes) {
+        const v_float32 x = vx_load(srcX + i), y = vx_load(srcY + i);
+        v_store(dstX + i, v_muladd(a, x, v_muladd(b, y, c)));
+        v_store(dstY + i, v_muladd(d, x, v_muladd(e, y, f)));
+    }
+#endif
+    for (; i < end; ++i) {
+        const float x = srcX[i], y = srcY[i];
+        dstX[i] = m(0,0)*x + m(0,1)*y + m(0,2);
+        dstY[i] = m(1,0)*x + m(1,1)*y + m(1,2);
+    }
+}
+
+static void applyHomography(const linalg::Mat33f& m, const float* srcX, const float* srcY, float* dstX, float* dstY, size_t begin, size_t end) {
+    size_t i = begin;
+#if CV_SIMD
+    const int lanes = v_float32::nlanes;
+    const v_float32 a = vx_setall_f32(m(0,0)), b = vx_setall_f32(m(0,1)), c = vx_setall_f32(m(0,2));
+    const v_float32 d = vx_setall_f32(m(1,0)), e = vx_setall_f32(m(1,1)), f = vx_setall_f32(m(1,2));
+    const v_float32 g = vx_setall_f32(m(2,0)), h = vx_setall_f32(m(2,1)), k = vx_setall_f32(m(2,2));
+    for (; i + lanes <= end; i += lanes) {
+        const v_float32 x = vx_load(srcX + i), y = vx_load(srcY + i);
+        const v_float32 w = v_muladd(g, x, v_muladd(h, y, k));
+        v_store(dstX + i, v_muladd(a, x, v_muladd(b, y, c))/w);
+        v_store(dstY + i, v_muladd(d, x, v_muladd(e, y, f))/w);
+    }
+#endif
+    for (; i < end; ++i) {
+        const float x = srcX[i], y = srcY[i];
+        const float w = m(2,0)*x + m(2,1)*y + m(2,2);
+        dstX[i] = (m(0,0)*x + m(0,1)*y + m(0,2))/w;
+        dstY[i] = (m(1,0)*x + m(1,1)*y + m(1,2))/w;
+    }
+}
+
+void Transform::apply(const float* srcX, const float* srcY, float* dstX, float* dstY, size_t n, bool parallel) const {
+    TRACE_SCOPE("transform.apply", uint64_t(n)*4*sizeof(float));
+    auto kernel = this->kind_ == Kind::Homography ? applyHomography : applyAffine;
+    //chunks of 64k points, big enough to amortize a task & to keep a chunk of both arrays in L2.
+    const size_t chunk = size_t(1) << 16;
+    if (!parallel || n <= chunk) {
+        kernel(this->matrix_, srcX, srcY, dstX, dstY, 0, n);
+        return;
+    }
+    const linalg::Mat33f& m = this->matrix_;
+    parallelRanges(int((n + chunk - 1)/chunk), 1, [&](const Range& chunks) {
+        kernel(m, srcX, srcY, dstX, dstY, chunks.start*chunk, std::min(n, chunks.end*chunk));
+    });
+}
+
+void Transform::apply(const PointArray& src, PointArray& dst, bool parallel) const {
+    CV_Assert(src.x.size() == src.y.size());
+    dst.resize(src.size());
+    apply(src.x.data(), src.y.data(), dst.x.data(), dst.y.data(), src.size(), parallel);
+}
+
+Point2f Rotation::rotate_pt_CW(const Point2f& pt, const Point2f& center, const Point2f& angles) {
+    const Point2f d = pt - center;
+    return Point2f(d.x*angles.x - d.y*angles.y + center.x, d.x*angles.y + d.y*angles.x + center.y);
+}
+
+Point2f Rotation::rotate_pt_CCW(const Point2f& pt, const Point2f& center, const Point2f& angles) {
+    const Point2f d = pt - center;
+    return Point2f(d.x*angles.x + d.y*angles.y + center.x, -d.x*angles.y + d.y*angles.x + center.y);
+}
+
 //see: https://en.wikipedia.org/wiki/Rotation_matrix
-//note: this is for GRAYSCALE only. Will need to be adapted for color images.
+//any type rotate() handles, nearest neighbour so the pixels are the original values.
 Mat Rotation::rotate_mat_CCW(Mat& I, const Point2i& center, const Point2f& angles) {
-    Mat rotated = Mat::zeros(I.size(), I.type());
-    
-    Point2i pt(0, 0);
-    for (int y = 0; y < I.rows; ++y) {
-        for (int x = 0; x < I.cols; ++x) {
-            pt = rotate_pt_CW(Point2i(x,y), center, angles);
-            if (pt.x < I.cols && pt.x > 0 && pt.y < I.rows && pt.y > 0) {
-                rotated.at<uchar>(y,x) = I.at<uchar>(pt.y,pt.x);
+    Mat rotated;
+    rotate(I, rotated, center, angles, INTER_NEAREST);
+    return rotated;
+}
+
+//a source pixel of a T image with cn channels. The sampling positions come in as floats, taps outside src read the border value.
+//src is a view rather than the Mat: the 8U samplers store through a uchar*, after which Mat::ptr has to load data & step again.
+template<typename T, int cn>
+static inline void sampleNearest(const MatView<const T>& src, float sx, float sy, const T* border, T* out) {
+    const int ix = cvRound(sx);
+    const int iy = cvRound(sy);
+    const T* p = src.contains(ix, iy) ? src[iy] + ix*cn : border;
+    for (int c = 0; c < cn; ++c) {
+        out[c] = p[c];
+    }
+}
+
+template<typename T, int cn>
+static inline void sampleBilinear(const MatView<const T>& src, float sx, float sy, const T* border, T* out) {
+    const int ix = cvFloor(sx);
+    const int iy = cvFloor(sy);
+    const float fx = sx - ix;
+    const float fy = sy - iy;
+    const T* p[4];
+    if ((unsigned)ix < (unsigned)(src.cols() - 1) && (unsigned)iy < (unsigned)(src.rows() - 1)) {
+        //all 4 taps inside, the usual case.
+        p[0] = src[iy] + ix*cn;
+        p[1] = p[0] + cn;
+        p[2] = src[iy + 1] + ix*cn;
+        p[3] = p[2] + cn;
+    }
+    else {
+        for (int i = 0; i < 4; ++i) {
+            const int tx = ix + (i & 1);
+            const int ty = iy + (i >> 1);
+            p[i] = src.contains(tx, ty) ? src[ty] + tx*cn : border;
+        }
+    }
+    for (int c = 0; c < cn; ++c) {
+        const float top = p[0][c] + fx*(float(p[1][c]) - p[0][c]);
+        const float bottom = p[2][c] + fx*(float(p[3][c]) - p[2][c]);
+        out[c] = saturate_cast<T>(top + fy*(bottom - top));
+    }
+}
+
+#if CV_SIMD
+//single channel float rows, a vector of pixels at a time: the coordinates, weights & gathers are all done in lanes.
+//vectors with a tap outside src fall back to the scalar sampler. Returns where the scalar loop has to pick up.
+static int rotateRowVec(const MatView<const float>& src, float* out, int cols, const float* colX, const float* colY, float baseX, float baseY, bool bilinear, const float* border) {
+    const int lanes = v_float32::nlanes;
+    const float* data = src.data();
+    const int step = int(src.step()/sizeof(float));
+    const v_float32 vbaseX = vx_setall_f32(baseX), vbaseY = vx_setall_f32(baseY);
+    const v_int32 vstep = vx_setall_s32(step);
+    const v_int32 vzero = vx_setzero_s32();
+    //the last valid index a tap can start at: the pixel itself for nearest, one before the edge for bilinear.
+    const v_int32 vmaxX = vx_setall_s32(src.cols() - (bilinear ? 2 : 1));
+    const v_int32 vmaxY = vx_setall_s32(src.rows() - (bilinear ? 2 : 1));
+    int idx[v_float32::nlanes];
+
+    int x = 0;
+    for (; x <= cols - lanes; x += lanes) {
+        const v_float32 sx = vx_load(colX + x) + vbaseX;
+        const v_float32 sy = vx_load(colY + x) + vbaseY;
+        const v_int32 ix = bilinear ? v_floor(sx) : v_round(sx);
+        const v_int32 iy = bilinear ? v_floor(sy) : v_round(sy);
+        const v_int32 inside = (ix >= vzero) & (ix <= vmaxX) & (iy >= vzero) & (iy <= vmaxY);
+        if (!v_check_all(inside)) {
+            for (int i = 0; i < lanes; ++i) {
+                if (bilinear) {
+                    sampleBilinear<float, 1>(src, colX[x + i] + baseX, colY[x + i] + baseY, border, out + x + i);
+                }
+                else {
+                    sampleNearest<float, 1>(src, colX[x + i] + baseX, colY[x + i] + baseY, border, out + x + i);
+                }
+            }
+            continue;
+        }
+        v_store(idx, iy*vstep + ix);
+        if (!bilinear) {
+            v_store(out + x, v_lut(data, idx));
+            continue;
+        }
+        const v_float32 fx = sx - v_cvt_f32(ix);
+        const v_float32 fy = sy - v_cvt_f32(iy);
+        const v_float32 p00 = v_lut(data, idx);
+        const v_float32 p01 = v_lut(data + 1, idx);
+        const v_float32 p10 = v_lut(data + step, idx);
+        const v_float32 p11 = v_lut(data + step + 1, idx);
+        const v_float32 top = v_muladd(fx, p01 - p00, p00);
+        const v_float32 bottom = v_muladd(fx, p11 - p10, p10);
+        v_store(out + x, v_muladd(fy, bottom - top, top));
+    }
+    return x;
+}
+#endif
+
+//the source position of dst(x, y) is colX[x] + baseX(y), colY[x] + baseY(y): the column terms are the same for
+//every row, so walking a row is one add per coordinate instead of a rotation per pixel.
+template<typename T, int cn>
+static void rotateRows(const MatView<const T>& src, const MatView<T>& dst, const float* colX, const float* colY, const Point2f& center, const Point2f& angles, bool bilinear, const T* border, const Range& rows, const Range& cols) {
+    for (int y = rows.start; y < rows.end; ++y) {
+        const float dy = y - center.y;
+        const float baseX = center.x - dy*angles.y;
+        const float baseY = center.y + dy*angles.x;
+        T* out = dst[y];
+        int x = cols.start;
+#if CV_SIMD
+        if constexpr (std::is_same<T, float>::value && cn == 1) {
+            x += rotateRowVec(src, out + x, cols.size(), colX + x, colY + x, baseX, baseY, bilinear, border);
+        }
+#endif
+        if (bilinear) {
+            for (; x < cols.end; ++x) {
+                sampleBilinear<T, cn>(src, colX[x] + baseX, colY[x] + baseY, border, out + x*cn);
+            }
+        }
+        else {
+            for (; x < cols.end; ++x) {
+                sampleNearest<T, cn>(src, colX[x] + baseX, colY[x] + baseY, border, out + x*cn);
+            }
+        }
+    }
+}
+
+//tileSize 0 splits the rows across cores with parallelRanges. Otherwise dst goes in tileSize x tileSize blocks, each a
+//task on the TaskScheduler pool of numThreads (1 = serially on this thread).
+template<typename T, int cn>
+static void rotateImage(const Mat& src, Mat& dst, const Point2f& center, const Point2f& angles, bool bilinear, const Scalar& borderValue, int tileSize, int numThreads) {
+    AutoBuffer<float> colX(dst.cols), colY(dst.cols);
+    for (int x = 0; x < dst.cols; ++x) {
+        colX[x] = (x - center.x)*angles.x;
+        colY[x] = (x - center.x)*angles.y;
+    }
+    T border[cn];
+    for (int c = 0; c < cn; ++c) {
+        border[c] = saturate_cast<T>(borderValue[c]);
+    }
+    const float* cx = colX.data();
+    const float* cy = colY.data();
+    const MatView<const T> in(src);
+    const MatView<T> out(dst);
+    if (tileSize == 0) {
+        parallelRanges(dst.rows, 4, [&](const Range& rows) {
+            TRACE_SCOPE("rotation.rotate.rows", uint64_t(rows.size())*dst.cols*dst.elemSize()*(bilinear ? 5 : 2));
+            rotateRows<T, cn>(in, out, cx, cy, center, angles, bilinear, border, rows, Range(0, dst.cols));
+        });
+        return;
+    }
+
+    const int tilesX = (dst.cols + tileSize - 1)/tileSize;
+    const int tilesY = (dst.rows + tileSize - 1)/tileSize;
+    auto runTile = [&](int i) {
+        const Range rows(i/tilesX*tileSize, std::min(i/tilesX*tileSize + tileSize, dst.rows));
+        const Range cols(i%tilesX*tileSize, std::min(i%tilesX*tileSize + tileSize, dst.cols));
+        TRACE_SCOPE("rotation.rotate.tile", uint64_t(rows.size())*cols.size()*dst.elemSize()*(bilinear ? 5 : 2));
+        rotateRows<T, cn>(in, out, cx, cy, center, angles, bilinear, border, rows, cols);
+    };
+    if (numThreads == 1) {
+        for (int i = 0; i < tilesX*tilesY; ++i) {
+            runTile(i);
+        }
+    }
+    else {
+        TaskGraph graph;
+        for (int i = 0; i < tilesX*tilesY; ++i) {
+            graph.add([&runTile, i]{ runTile(i); });
+        }
+        graph.run(TaskScheduler::get(numThreads));
+    }
+}
+
+template<typename T>
+static void rotateChannels(const Mat& src, Mat& dst, const Point2f& center, const Point2f& angles, bool bilinear, const Scalar& borderValue, int tileSize, int numThreads) {
+    switch (src.channels()) {
+        case 1: rotateImage<T, 1>(src, dst, center, angles, bilinear, borderValue, tileSize, numThreads); break;
+        case 2: rotateImage<T, 2>(src, dst, center, angles, bilinear, borderValue, tileSize, numThreads); break;
+        case 3: rotateImage<T, 3>(src, dst, center, angles, bilinear, borderValue, tileSize, numThreads); break;
+        case 4: rotateImage<T, 4>(src, dst, center, angles, bilinear, borderValue, tileSize, numThreads); break;
+    }
+}
+
+//quarter turns & flips only move whole pixels, so they're copies of elemSize bytes whatever the type & channels.
+template<int N>
+struct PixelBytes {
+    uchar bytes[N];
+};
+
+//the 8 ways to turn & mirror the pixel grid: dst(x, y) = src(sx, sy) with (u, v) = transpose ? (y, x) : (x, y) and
+//sx = flipX ? ox - u : ox + u, sy = flipY ? oy - v : oy + v. Only the rows [y0, y1) of rect, which must map inside src.
+//Without a transpose a dst row is one src row (a memcpy, or read backwards). With one a dst row walks down a src column,
+//so the rect goes in blocks of 32 x 32: the 32 src rows a block reads stay in L1 until its last column is done.
+template<typename P, bool transpose, bool flipX, bool flipY>
+static void quarterTurnRows(const MatView<const P>& src, const MatView<P>& dst, int ox, int oy, const Rect& rect, int y0, int y1) {
+    const int block = transpose ? 32 : rect.width;
+    for (int bx = rect.x; bx < rect.x + rect.width; bx += block) {
+        const int bx1 = std::min(bx + block, rect.x + rect.width);
+        for (int y = y0; y < y1; ++y) {
+            P* out = dst[y];
+            if constexpr (!transpose) {
+                const P* in = src[flipY ? oy - y : oy + y];
+                if constexpr (flipX) {
+                    for (int x = bx; x < bx1; ++x) {
+                        out[x] = in[ox - x];
+                    }
+                }
+                else {
+                    std::memcpy(out + bx, in + ox + bx, (bx1 - bx)*sizeof(P));
+                }
             }
             else {
-                rotated.at<uchar>(y,x) = (uchar)0;
+                const int column = flipX ? ox - y : ox + y;
+                for (int x = bx; x < bx1; ++x) {
+                    out[x] = src[flipY ? oy - x : oy + x][column];
+                }
             }
-        
         }
     }
+}
 
-    return rotated;
+template<typename P, bool transpose, bool flipX, bool flipY>
+static void quarterTurnImage(const MatView<const P>& src, const MatView<P>& dst, int ox, int oy, const Rect& rect) {
+    //bands of 32 rows, the height of a block.
+    const int bands = (rect.height + 31)/32;
+    parallelRanges(bands, 1, [&](const Range& range) {
+        TRACE_SCOPE("rotation.quarterTurn.rows", uint64_t(std::min(range.end*32, rect.height) - range.start*32)*rect.width*sizeof(P)*2);
+        quarterTurnRows<P, transpose, flipX, flipY>(src, dst, ox, oy, rect, rect.y + range.start*32, rect.y + std::min(range.end*32, rect.height));
+    });
 }
 
-Mat Rotation::getRotatedWindow(Mat& I, const Point2i& center, int windowSize, float theta, bool degrees) {
-    int padding = windowSize/2;
-    Point2i windowStart(center.x - padding, center.y - padding);
-    Point2i windowEnd(center.x + padding, center.y + padding);
+template<typename P>
+static void quarterTurnPixels(const Mat& src, Mat& dst, int ox, int oy, const Rect& rect, bool transpose, bool flipX, bool flipY) {
+    const MatView<const P> in(reinterpret_cast<const P*>(src.data), src.rows, src.cols, src.step);
+    const MatView<P> out(reinterpret_cast<P*>(dst.data), dst.rows, dst.cols, dst.step);
+    switch ((transpose ? 4 : 0) | (flipX ? 2 : 0) | (flipY ? 1 : 0)) {
+        case 0: quarterTurnImage<P, false, false, false>(in, out, ox, oy, rect); break;
+        case 1: quarterTurnImage<P, false, false, true>(in, out, ox, oy, rect); break;
+        case 2: quarterTurnImage<P, false, true, false>(in, out, ox, oy, rect); break;
+        case 3: quarterTurnImage<P, false, true, true>(in, out, ox, oy, rect); break;
+        case 4: quarterTurnImage<P, true, false, false>(in, out, ox, oy, rect); break;
+        case 5: quarterTurnImage<P, true, false, true>(in, out, ox, oy, rect); break;
+        case 6: quarterTurnImage<P, true, true, false>(in, out, ox, oy, rect); break;
+        case 7: quarterTurnImage<P, true, true, true>(in, out, ox, oy, rect); break;
+    }
+}
 
-    Mat ROI = Mat::zeros(windowSize, windowSize, I.type());
-    const Point2f angles = cos_sin_of_angle(theta, degrees);
+//the dst pixels whose source is inside src, clipped to dst.
+static Rect quarterTurnRect(const Size& srcSize, const Size& dstSize, int ox, int oy, bool transpose, bool flipX, bool flipY) {
+    //the u & v that land inside src, then (x, y) is (u, v) or (v, u).
+    const int u0 = flipX ? ox - srcSize.width + 1 : -ox;
+    const int v0 = flipY ? oy - srcSize.height + 1 : -oy;
+    const Rect uv(u0, v0, srcSize.width, srcSize.height);
+    const Rect xy = transpose ? Rect(uv.y, uv.x, uv.height, uv.width) : uv;
+    return xy & Rect(Point(0, 0), dstSize);
+}
+
+//dst (already allocated, not src) gets the turned / mirrored src, the pixels from outside src get borderValue.
+static void quarterTurn(const Mat& src, Mat& dst, int ox, int oy, bool transpose, bool flipX, bool flipY, const Scalar& borderValue) {
+    const Rect rect = quarterTurnRect(src.size(), dst.size(), ox, oy, transpose, flipX, flipY);
+    TRACE_SCOPE("rotation.quarterTurn", uint64_t(rect.area())*dst.elemSize()*2);
+    if (rect.empty()) {
+        dst.setTo(borderValue);
+        return;
+    }
+    //the border strips above, below, left & right of rect.
+    const Rect strips[] = {Rect(0, 0, dst.cols, rect.y), Rect(0, rect.br().y, dst.cols, dst.rows - rect.br().y),
+                           Rect(0, rect.y, rect.x, rect.height), Rect(rect.br().x, rect.y, dst.cols - rect.br().x, rect.height)};
+    for (const Rect& strip : strips) {
+        if (!strip.empty()) {
+            dst(strip).setTo(borderValue);
+        }
+    }
+    switch (src.elemSize()) {
+        case 1: quarterTurnPixels<PixelBytes<1>>(src, dst, ox, oy, rect, transpose, flipX, flipY); break;
+        case 2: quarterTurnPixels<PixelBytes<2>>(src, dst, ox, oy, rect, transpose, flipX, flipY); break;
+        case 3: quarterTurnPixels<PixelBytes<3>>(src, dst, ox, oy, rect, transpose, flipX, flipY); break;
+        case 4: quarterTurnPixels<PixelBytes<4>>(src, dst, ox, oy, rect, transpose, flipX, flipY); break;
+        case 6: quarterTurnPixels<PixelBytes<6>>(src, dst, ox, oy, rect, transpose, flipX, flipY); break;
+        case 8: quarterTurnPixels<PixelBytes<8>>(src, dst, ox, oy, rect, transpose, flipX, flipY); break;
+        case 12: quarterTurnPixels<PixelBytes<12>>(src, dst, ox, oy, rect, transpose, flipX, flipY); break;
+        case 16: quarterTurnPixels<PixelBytes<16>>(src, dst, ox, oy, rect, transpose, flipX, flipY); break;
+        case 24: quarterTurnPixels<PixelBytes<24>>(src, dst, ox, oy, rect, transpose, flipX, flipY); break;
+        case 32: quarterTurnPixels<PixelBytes<32>>(src, dst, ox, oy, rect, transpose, flipX, flipY); break;
+        default: CV_Error(Error::StsUnsupportedFormat, "unsupported pixel size");
+    }
+}
+
+bool Rotation::isQuarterTurn(const Point2f& angles, int& turns) {
+    //the tables give whole degrees exactly, the tolerance is for angles that went through radians (cos(pi/2) ~ -4e-8).
+    const float eps = 1e-6f;
+    const bool axisX = std::abs(angles.y) < eps && std::abs(std::abs(angles.x) - 1.0f) < eps;
+    const bool axisY = std::abs(angles.x) < eps && std::abs(std::abs(angles.y) - 1.0f) < eps;
+    if (axisX) {
+        turns = angles.x > 0 ? 0 : 2;
+    }
+    else if (axisY) {
+        turns = angles.y > 0 ? 1 : 3;
+    }
+    return axisX || axisY;
+}
+
+//counter clockwise like rotate(): 1 turn is dst(x, y) = src(cols - 1 - y, x), the same as cv::rotate's ROTATE_90_COUNTERCLOCKWISE.
+void Rotation::rotateQuarter(const Mat& src, Mat& dst, int turns) {
+    turns = ((turns % 4) + 4) % 4;
+    const Mat source = src.data == dst.data ? src.clone() : src;
+    const int W = source.cols, H = source.rows;
+    dst.create(turns % 2 ? Size(H, W) : Size(W, H), source.type());
+    switch (turns) {
+        case 0: quarterTurn(source, dst, 0, 0, false, false, false, Scalar()); break;
+        case 1: quarterTurn(source, dst, W - 1, 0, true, true, false, Scalar()); break;
+        case 2: quarterTurn(source, dst, W - 1, H - 1, false, true, true, Scalar()); break;
+        case 3: quarterTurn(source, dst, 0, H - 1, true, false, true, Scalar()); break;
+    }
+}
+
+//flipCode like cv::flip: 0 about the x axis (upside down), > 0 about the y axis (left to right), < 0 both.
+void Rotation::flip(const Mat& src, Mat& dst, int flipCode) {
+    const Mat source = src.data == dst.data ? src.clone() : src;
+    dst.create(source.size(), source.type());
+    const bool flipX = flipCode != 0;
+    const bool flipY = flipCode <= 0;
+    quarterTurn(source, dst, flipX ? source.cols - 1 : 0, flipY ? source.rows - 1 : 0, false, flipX, flipY, Scalar());
+}
+
+//a quarter turn about a center that maps pixels onto pixels (an integer center, or both coordinates halves) samples
+//exactly at pixel centers, where both interpolations give the pixel itself: copy instead. false if it isn't one.
+//  sx = cx + c (x - cx) - s (y - cy),  sy = cy + s (x - cx) + c (y - cy)
+static bool rotateByCopy(const Mat& src, Mat& dst, const Point2f& center, const Point2f& angles, const Scalar& borderValue) {
+    int turns = 0;
+    if (!Rotation::isQuarterTurn(angles, turns)) {
+        return false;
+    }
+    const int c[] = {1, 0, -1, 0};
+    const int s[] = {0, 1, 0, -1};
+    const float ox = center.x - c[turns]*center.x + s[turns]*center.y;
+    const float oy = center.y - s[turns]*center.x - c[turns]*center.y;
+    if (ox != std::floor(ox) || oy != std::floor(oy)) {
+        return false;
+    }
+    const bool transpose = turns % 2 == 1;
+    const bool flipX = turns == 1 || turns == 2;
+    const bool flipY = turns == 2 || turns == 3;
+    quarterTurn(src, dst, int(ox), int(oy), transpose, flipX, flipY, borderValue);
+    return true;
+}
+
+static void rotateImpl(const Mat& src, Mat& dst, const Point2f& center, const Point2f& angles, int interpolation, const Scalar& borderValue, int tileSize, int numThreads) {
+    CV_Assert((src.depth() == CV_8U || src.depth() == CV_32F) && src.channels() <= 4);
+    CV_Assert(interpolation == INTER_NEAREST || interpolation == INTER_LINEAR);
+    //rotating in place would read pixels that were already written.
+    const Mat source = src.data == dst.data ? src.clone() : src;
+    dst.create(source.size(), source.type());
+    if (rotateByCopy(source, dst, center, angles, borderValue)) {
+        return;
+    }
+    const bool bilinear = interpolation == INTER_LINEAR;
+    if (source.depth() == CV_8U) {
+        rotateChannels<uchar>(source, dst, center, angles, bilinear, borderValue, tileSize, numThreads);
+    }
+    else {
+        rotateChannels<float>(source, dst, center, angles, bilinear, borderValue, tileSize, numThreads);
+    }
+}
+
+void Rotation::rotate(const Mat& src, Mat& dst, const Point2f& center, const Point2f& angles, int interpolation, const Scalar& borderValue) {
+    TRACE_SCOPE("rotation.rotate");
+    rotateImpl(src, dst, center, angles, interpolation, borderValue, 0, 0);
+}
+
+//a dst tile turned by up to 45 degrees reads a source footprint of up to twice its area, and bilinear reads one more row.
+//The largest power of 2 side where that & the tile itself take up 3 * tile^2 * elemSize <= 128KB, half of a small L2,
+//so the footprint of a tile is still cached while the tile is written: 128 for 8UC1, 64 for 32FC1, 32 for 32FC4.
+int Rotation::rotationTileSize(size_t elemSize) {
+    const size_t budget = 128*1024;
+    int tile = 256;
+    while (tile > 16 && size_t(tile)*tile*elemSize*3 > budget) {
+        tile /= 2;
+    }
+    return tile;
+}
+
+void Rotation::rotateTiled(const Mat& src, Mat& dst, const Point2f& center, const Point2f& angles, int interpolation, const Scalar& borderValue, int numThreads, int tileSize) {
+    TRACE_SCOPE("rotation.rotateTiled");
+    CV_Assert(tileSize >= 0);
+    int tile = tileSize > 0 ? tileSize : rotationTileSize(src.elemSize());
+#if CV_SIMD
+    //single channel float rows go a vector at a time from the left of a tile, & the vectors sample with FMAs the scalar
+    //tail doesn't use. Tiles a whole number of vectors wide cut a row into the same vectors as rotate(), so they match.
+    const int lanes = v_float32::nlanes;
+    tile = (tile + lanes - 1)/lanes*lanes;
+#endif
+    rotateImpl(src, dst, center, angles, interpolation, borderValue, tile, numThreads);
+}
+
+//a window's source positions are its center plus the rotated & scaled offsets of the patch pixels from the patch center,
+//which are the same for every row & column, so only the per window cos & sin change.
+template<typename T, int cn>
+static void extractWindowRange(const MatView<const T>& src, const RotatedWindowArray& windows, int patchSize, const MatView<T>& dst, bool bilinear, bool degrees, const T* border, const Range& range) {
+    AutoBuffer<float> offsets(patchSize);
+    for (int i = 0; i < patchSize; ++i) {
+        offsets[i] = i - 0.5f*(patchSize - 1);
+    }
+    for (int k = range.start; k < range.end; ++k) {
+        const Point2f angles = Rotation::cos_sin_of_angle(windows.angle[k], degrees);
+        const float scale = windows.windowSize[k]/patchSize;
+        const float ax = angles.x*scale;
+        const float ay = angles.y*scale;
+        const float cx = windows.x[k];
+        const float cy = windows.y[k];
+        for (int v = 0; v < patchSize; ++v) {
+            const float rowX = cx - ay*offsets[v];
+            const float rowY = cy + ax*offsets[v];
+            T* out = dst[k*patchSize + v];
+            if (bilinear) {
+                for (int u = 0; u < patchSize; ++u) {
+                    sampleBilinear<T, cn>(src, rowX + ax*offsets[u], rowY + ay*offsets[u], border, out + u*cn);
+                }
+            }
+            else {
+                for (int u = 0; u < patchSize; ++u) {
+                    sampleNearest<T, cn>(src, rowX + ax*offsets[u], rowY + ay*offsets[u], border, out + u*cn);
+                }
+            }
+        }
+    }
+}
 
+template<typename T, int cn>
+static void extractWindowsImpl(const Mat& src, const RotatedWindowArray& windows, int patchSize, Mat& dst, bool bilinear, bool degrees, const Scalar& borderValue) {
+    T border[cn];
+    for (int c = 0; c < cn; ++c) {
+        border[c] = saturate_cast<T>(borderValue[c]);
+    }
+    //at least 16 windows per range, enough to amortize the offsets table.
+    const int n = int(windows.size());
+    const MatView<const T> in(src);
+    const MatView<T> out(dst);
+    parallelRanges(n, 16, [&](const Range& range) {
+        extractWindowRange<T, cn>(in, windows, patchSize, out, bilinear, degrees, border, range);
+    });
+}
 
-    //TODO:
-    //take a window around the center point. 
-    //Check if point's window is within image.
-    //note! Be careful about this part, we need to account for the rotated window to be within the
-    //image, NOT the normal window!
-    if (windowStart.x > 0 && windowEnd.x < I.cols && windowStart.y > 0 && windowEnd.y < I.rows) {
-        //the point's window won't expand beyond image border. No padding.
+template<typename T>
+static void extractWindowsChannels(const Mat& src, const RotatedWindowArray& windows, int patchSize, Mat& dst, bool bilinear, bool degrees, const Scalar& borderValue) {
+    switch (src.channels()) {
+        case 1: extractWindowsImpl<T, 1>(src, windows, patchSize, dst, bilinear, degrees, borderValue); break;
+        case 2: extractWindowsImpl<T, 2>(src, windows, patchSize, dst, bilinear, degrees, borderValue); break;
+        case 3: extractWindowsImpl<T, 3>(src, windows, patchSize, dst, bilinear, degrees, borderValue); break;
+        case 4: extractWindowsImpl<T, 4>(src, windows, patchSize, dst, bilinear, degrees, borderValue); break;
+    }
+}
+
+void Rotation::extractWindows(const Mat& src, const RotatedWindowArray& windows, int patchSize, Mat& dst, int interpolation, bool degrees, const Scalar& borderValue) {
+    CV_Assert((src.depth() == CV_8U || src.depth() == CV_32F) && src.channels() <= 4 && patchSize > 0);
+    CV_Assert(interpolation == INTER_NEAREST || interpolation == INTER_LINEAR);
+    TRACE_SCOPE("rotation.extractWindows", uint64_t(windows.size())*patchSize*patchSize*src.elemSize()*(interpolation == INTER_LINEAR ? 5 : 2));
+    CV_Assert(windows.y.size() == windows.size() && windows.angle.size() == windows.size() && windows.windowSize.size() == windows.size());
+    CV_Assert(src.data != dst.data);
+    if (windows.size() == 0) {
+        dst.release();
+        return;
+    }
+    dst.create(int(windows.size())*patchSize, patchSize, src.type());
+    const bool bilinear = interpolation == INTER_LINEAR;
+    if (src.depth() == CV_8U) {
+        extractWindowsChannels<uchar>(src, windows, patchSize, dst, bilinear, degrees, borderValue);
     }
     else {
-        //if the point's window will expand beyond the image border, it will need padding.
+        extractWindowsChannels<float>(src, windows, patchSize, dst, bilinear, degrees, borderValue);
+    }
+}
+
+RotatedOffsets::RotatedOffsets(int windowSize, const Point2f& angles) : windowSize_{windowSize} {
+    CV_Assert(windowSize > 0);
+    //the same (truncating) rotation as rotate_pt_CW, around the center pixel of the window.
+    const int padding = windowSize/2;
+    this->offsets_.resize(size_t(windowSize)*windowSize);
+    Point2i lo(INT_MAX, INT_MAX), hi(INT_MIN, INT_MIN);
+    for (int i = 0; i < windowSize; ++i) {
+        for (int j = 0; j < windowSize; ++j) {
+            const int dx = j - padding;
+            const int dy = i - padding;
+            const Point2i offset(int(dx*angles.x - dy*angles.y), int(dx*angles.y + dy*angles.x));
+            this->offsets_[size_t(i)*windowSize + j] = offset;
+            lo = Point2i(std::min(lo.x, offset.x), std::min(lo.y, offset.y));
+            hi = Point2i(std::max(hi.x, offset.x), std::max(hi.y, offset.y));
+        }
+    }
+    this->bounds_ = Rect(lo, hi + Point2i(1, 1));
+}
+
+RotatedOffsetTable::RotatedOffsetTable(int windowSize, int numBins)
+    : windowSize_{windowSize}, numBins_{numBins}, grids_{new std::atomic<const RotatedOffsets*>[numBins]} {
+    CV_Assert(windowSize > 0 && numBins > 0);
+    for (int i = 0; i < numBins; ++i) {
+        this->grids_[i].store(nullptr, std::memory_order_relaxed);
     }
+}
 
+RotatedOffsetTable::~RotatedOffsetTable() {
+    for (int i = 0; i < this->numBins_; ++i) {
+        delete this->grids_[i].load(std::memory_order_relaxed);
+    }
+}
+
+const RotatedOffsets& RotatedOffsetTable::operator[](int bin) const {
+    CV_Assert(bin >= 0 && bin < this->numBins_);
+    std::atomic<const RotatedOffsets*>& slot = this->grids_[bin];
+    const RotatedOffsets* grid = slot.load(std::memory_order_acquire);
+    if (grid) {
+        return *grid;
+    }
+    //first use: build it, and if another thread got there first use theirs instead.
+    const Point2f angles = this->numBins_ == 360 ? trigLUT360.angles(bin)
+                         : this->numBins_ == 36 ? trigLUT36.angles(bin)
+                         : Rotation::cos_sin_of_angle(float(2*CV_PI*bin/this->numBins_), false);
+    std::unique_ptr<RotatedOffsets> built = std::make_unique<RotatedOffsets>(this->windowSize_, angles);
+    if (slot.compare_exchange_strong(grid, built.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+        return *built.release();
+    }
+    return *grid;
+}
 
-    //iterate over the coordinates which will surround the point.
-    Point2i pt_rotated(0,0);
-    for (int i = windowStart.y; i <= windowEnd.y; ++i) {
-        for (int j = windowStart.x; j <= windowEnd.x; ++j) {
-            pt_rotated = rotate_pt_CW(Point2i(j,i), center, angles);
-            ROI.at<uchar>(i - windowStart.y, j-windowStart.x) = I.at<uchar>(pt_rotated.y, pt_rotated.x);
+const RotatedOffsetTable& RotatedOffsets::table(int windowSize, int numBins) {
+    CV_Assert(windowSize > 0 && numBins > 0);
+    //the usual case, whole degrees & small windows: a slot per windowSize, published like the grids of a table.
+    //the tables live until the program ends.
+    if (numBins == 360 && windowSize < maxTableWindow) {
+        static std::atomic<const RotatedOffsetTable*> tables[maxTableWindow] = {};
+        std::atomic<const RotatedOffsetTable*>& slot = tables[windowSize];
+        const RotatedOffsetTable* table = slot.load(std::memory_order_acquire);
+        if (!table) {
+            std::unique_ptr<RotatedOffsetTable> built = std::make_unique<RotatedOffsetTable>(windowSize, numBins);
+            if (slot.compare_exchange_strong(table, built.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+                table = built.release();
+            }
+        }
+        return *table;
+    }
+
+    static std::mutex lock;
+    static std::map<std::pair<int, int>, std::unique_ptr<RotatedOffsetTable>> tables;
+    std::lock_guard<std::mutex> guard(lock);
+    std::unique_ptr<RotatedOffsetTable>& entry = tables[std::make_pair(windowSize, numBins)];
+    if (!entry) {
+        entry = std::make_unique<RotatedOffsetTable>(windowSize, numBins);
+    }
+    return *entry;
+}
+
+const RotatedOffsets& RotatedOffsets::get(int windowSize, int bin, int numBins) {
+    return table(windowSize, numBins)[bin];
+}
+
+Mat Rotation::getRotatedWindow(Mat& I, const Point2i& center, int windowSize, float theta, bool degrees, int borderType, const Scalar& borderValue) {
+    TRACE_SCOPE("rotation.getRotatedWindow", uint64_t(windowSize)*windowSize*I.elemSize()*2);
+    CV_Assert(borderType == BORDER_CONSTANT || borderType == BORDER_REPLICATE || borderType == BORDER_REFLECT ||
+              borderType == BORDER_REFLECT_101 || borderType == BORDER_WRAP);
+
+    //whole degrees share a cached grid, anything in between gets its own.
+    std::unique_ptr<RotatedOffsets> uncached;
+    const RotatedOffsets* grid = nullptr;
+    if (degrees && theta == std::floor(theta) && std::abs(theta) < 1e6f) {
+        grid = &RotatedOffsets::get(windowSize, TrigLUT<360>::bin(theta));
+    }
+    else {
+        uncached = std::make_unique<RotatedOffsets>(windowSize, cos_sin_of_angle(theta, degrees));
+        grid = uncached.get();
+    }
+
+    const size_t elemSize = I.elemSize();
+    const Point2i* offsets = grid->offsets().data();
+    //any type, so the pixels are elemSize bytes.
+    const MatView<const uchar> in(I.data, I.rows, I.cols, I.step, int(elemSize));
+
+    //note! it's the rotated window that has to be within the image, not the normal window: grid->bounds() is its footprint.
+    const Rect footprint = grid->bounds() + center;
+    if ((footprint & Rect(0, 0, I.cols, I.rows)) == footprint) {
+        //the window won't reach the image border, so no pixel needs checking.
+        Mat ROI(windowSize, windowSize, I.type());
+        const MatView<uchar> out(ROI.data, ROI.rows, ROI.cols, ROI.step, int(elemSize));
+        for (int i = 0; i < windowSize; ++i) {
+            for (int j = 0; j < windowSize; ++j) {
+                const Point2i src = center + offsets[i*windowSize + j];
+                std::memcpy(out.ptr(i, j), in.ptr(src.y, src.x), elemSize);
+            }
+        }
+        return ROI;
+    }
+
+    //otherwise every pixel is checked. A constant border is already in the window, others map back into the image.
+    Mat ROI = borderType == BORDER_CONSTANT ? Mat(windowSize, windowSize, I.type(), borderValue) : Mat(windowSize, windowSize, I.type());
+    const MatView<uchar> out(ROI.data, ROI.rows, ROI.cols, ROI.step, int(elemSize));
+    for (int i = 0; i < windowSize; ++i) {
+        for (int j = 0; j < windowSize; ++j) {
+            Point2i src = center + offsets[i*windowSize + j];
+            if (!in.contains(src.x, src.y)) {
+                if (borderType == BORDER_CONSTANT) {
+                    continue;
+                }
+                src.x = borderInterpolate(src.x, I.cols, borderType);
+                src.y = borderInterpolate(src.y, I.rows, borderType);
+            }
+            std::memcpy(out.ptr(i, j), in.ptr(src.y, src.x), elemSize);
         }
     }
 
@@ -106,11 +826,16 @@ Mat Rotation::getRotatedWindow(Mat& I, const Point2i& center, int windowSize, fl
 }
 
 Point Rotation::drawRotated(Point& pt, Mat& src, Mat& roi_rotation_mat, bool draw) {
-    Mat pos = Mat(Vec3d(pt.x, pt.y, 1));    //convert pt to mat for multiplication
-    
-    //Now, rotate the point.
-    Mat pos_rotated = roi_rotation_mat*pos;
-    Point pt_rotated((int)pos_rotated.at<double>(0), (int)pos_rotated.at<double>(1));
+    CV_Assert(roi_rotation_mat.rows == 2 && roi_rotation_mat.cols == 3 && roi_rotation_mat.type() == CV_64F);
+    const double* r0 = roi_rotation_mat.ptr<double>(0);
+    const double* r1 = roi_rotation_mat.ptr<double>(1);
+    return drawRotated(pt, src, linalg::Mat23d{r0[0], r0[1], r0[2], r1[0], r1[1], r1[2]}, draw);
+}
+
+Point Rotation::drawRotated(Point& pt, Mat& src, const linalg::Mat23d& roi_rotation_mat, bool draw) {
+    //rotate the point: M * (x, y, 1), on the stack.
+    const linalg::Vec2d pos_rotated = roi_rotation_mat*linalg::Vec3d{double(pt.x), double(pt.y), 1.0};
+    Point pt_rotated((int)pos_rotated[0], (int)pos_rotated[1]);
 
     if (draw) {
         circle(src, pt, 3, Scalar(255,255,255), 2);        //draw white circle
@@ -124,8 +849,8 @@ Mat Rotation::doubleCrop(Mat& src, const Point2i& center, int windowSize, double
     int padding = windowSize/2;
     double scale = 1.0;      //scaling is optional
 
-    //generate the rotation matrix with cv::getRotationMatrix2D
-    Mat rotation_mat = getRotationMatrix2D(center, angle, scale);
+    //generate the rotation matrix of cv::getRotationMatrix2D, as a fixed size matrix.
+    const linalg::Mat23d rotation_mat = linalg::rotationMatrix2D(center, angle, scale);
 
 
     //Make a function out of this
@@ -142,13 +867,10 @@ Mat Rotation::doubleCrop(Mat& src, const Point2i& center, int windowSize, double
     Point pos4_r = drawRotated(pos4, src, rotation_mat, false);
 
     //note, this actually needs to be performed for every single pixel..
-    std::vector<int> x_positions = {pos1_r.x, pos2_r.x, pos3_r.x, pos4_r.x};
-    std::vector<int> y_positions = {pos1_r.y, pos2_r.y, pos3_r.y, pos4_r.y};
-    
-    int min_x = *min_element(x_positions.begin(), x_positions.end());
-    int max_x = *max_element(x_positions.begin(), x_positions.end());
-    int min_y = *min_element(y_positions.begin(), y_positions.end());
-    int max_y = *max_element(y_positions.begin(), y_positions.end());
+    int min_x = std::min({pos1_r.x, pos2_r.x, pos3_r.x, pos4_r.x});
+    int max_x = std::max({pos1_r.x, pos2_r.x, pos3_r.x, pos4_r.x});
+    int min_y = std::min({pos1_r.y, pos2_r.y, pos3_r.y, pos4_r.y});
+    int max_y = std::max({pos1_r.y, pos2_r.y, pos3_r.y, pos4_r.y});
 
     //what about constructing these into points, then applying the rotation.
     //Will that give the cropping boundaries?
@@ -158,7 +880,7 @@ Mat Rotation::doubleCrop(Mat& src, const Point2i& center, int windowSize, double
 
     //now, rotate the ROI.
     Point roi_center = Point(ROI.cols/2, ROI.rows/2);
-    Mat roi_rotation_mat = getRotationMatrix2D(roi_center, angle, scale);
+    const linalg::Mat23d roi_rotation_mat = linalg::rotationMatrix2D(roi_center, angle, scale);
 
     Point roi_pos1(ROI.cols/2, 0);           //top
     Point roi_pos2(0,ROI.rows/2);           //left
@@ -170,7 +892,7 @@ Mat Rotation::doubleCrop(Mat& src, const Point2i& center, int windowSize, double
     Point roi_rot_pos4 = drawRotated(roi_pos4, ROI, roi_rotation_mat, false);      //use this
 
     Mat rotate_dst;
-    warpAffine(ROI, rotate_dst, roi_rotation_mat, ROI.size());
+    warpAffine(ROI, rotate_dst, Mat(Matx23d(roi_rotation_mat)), ROI.size());
 
     //finally, take a new ROI from the rotate_dst
     Mat cropped(rotate_dst, Rect(roi_rot_pos1, roi_rot_pos4));
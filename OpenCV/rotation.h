@@ -1,23 +1,169 @@
 #pragma once
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/core/hal/intrin.hpp>
 #include <cmath>
+#include <vector>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstring>
+#include <climits>
+#include "trig_lut.h"
+#include "Trace.hpp"
+#include "linalg.h"
+#include "matview.h"
+#include "TaskScheduler.hpp"
 
 using namespace cv;
 
 namespace SLAM {
-    class Transform {};
+    //2D points as a structure of arrays, so a transform reads & writes whole vectors of x & y.
+    struct PointArray {
+        std::vector<float> x, y;
+        size_t size() const { return this->x.size(); }
+        void resize(size_t n) { this->x.resize(n); this->y.resize(n); }
+        void clear() { this->x.clear(); this->y.clear(); }
+        void push_back(float px, float py) {
+            this->x.push_back(px);
+            this->y.push_back(py);
+        }
+    };
+
+    //A 2D transform applied to whole point sets in float: one matrix, a SIMD kernel per kind, and optionally the points split
+    //across cores. The default is the identity.
+    //  Affine:     p' = A p + t
+    //  Rigid:      affine with A a rotation, so the inverse is exact (the transpose).
+    //  Homography: p' = (H (x, y, 1)) / w, a point mapped to w == 0 comes out as inf / nan.
+    class Transform {
+        public:
+            enum class Kind { Affine, Rigid, Homography };
+            Transform() : matrix_{linalg::Mat33f::eye()} {}
+            static Transform affine(const linalg::Mat23f& m);
+            //rotated by angles = (cos, sin) like rotate_pt_CW, then moved by translation.
+            static Transform rigid(const Point2f& angles, const Point2f& translation);
+            //rotate_pt_CW about center, in float.
+            static Transform rotation(const Point2f& center, const Point2f& angles);
+            static Transform homography(const linalg::Mat33f& h);
+            Kind kind() const { return this->kind_; }
+            //always 3x3, the last row of an affine / rigid transform is (0, 0, 1).
+            const linalg::Mat33f& matrix() const { return this->matrix_; }
+            Transform inverse() const;
+            //this after other.
+            Transform operator*(const Transform& other) const;
+            Point2f apply(const Point2f& pt) const;
+            //dstX/dstY may be srcX/srcY. parallel splits the points across cores on the TaskScheduler pool, like the rest
+            //of the module, only worth it for large sets.
+            void apply(const float* srcX, const float* srcY, float* dstX, float* dstY, size_t n, bool parallel = false) const;
+            void apply(const PointArray& src, PointArray& dst, bool parallel = false) const;
+        private:
+            Kind kind_ = Kind::Rigid;
+            linalg::Mat33f matrix_;
+    };
+
+    //oriented windows as a structure of arrays, one entry per window in every array.
+    //(x, y) is the center, angle turns the window counter clockwise like getRotatedWindow, and windowSize is the
+    //width of the square of source pixels it covers.
+    struct RotatedWindowArray {
+        std::vector<float> x, y, angle, windowSize;
+        size_t size() const { return this->x.size(); }
+        void clear() { this->x.clear(); this->y.clear(); this->angle.clear(); this->windowSize.clear(); }
+        void push_back(float px, float py, float theta, float window) {
+            this->x.push_back(px);
+            this->y.push_back(py);
+            this->angle.push_back(theta);
+            this->windowSize.push_back(window);
+        }
+    };
+
+    class RotatedOffsetTable;
+
+    //the source offsets, from the window center, that getRotatedWindow reads for every pixel of a windowSize x windowSize
+    //window turned by one of numBins angles, row major. Orientations are binned, so the same few grids come up over and
+    //over: each is built once & kept, after that a window is only table loads.
+    class RotatedOffsets {
+        public:
+            //the grids of one windowSize, built on first use & kept for the rest of the program. For numBins = 360 &
+            //windowSize < maxTableWindow finding the table is one atomic load, other tables are looked up under a lock,
+            //so hold on to the table in a loop over many windows.
+            static const RotatedOffsetTable& table(int windowSize, int numBins = 360);
+            static const RotatedOffsets& get(int windowSize, int bin, int numBins = 360);
+            static constexpr int maxTableWindow = 256;
+            RotatedOffsets(int windowSize, const Point2f& angles);
+            int windowSize() const { return this->windowSize_; }
+            const std::vector<Point2i>& offsets() const { return this->offsets_; }
+            //the smallest rect around every offset, i.e. the footprint of the turned window.
+            const Rect& bounds() const { return this->bounds_; }
+        private:
+            int windowSize_ = 0;
+            std::vector<Point2i> offsets_;
+            Rect bounds_;
+    };
+
+    //the RotatedOffsets of every bin of one windowSize. A bin's grid is built by the first thread that asks for it &
+    //published with a compare & swap, so reading the table never takes a lock.
+    class RotatedOffsetTable {
+        public:
+            RotatedOffsetTable(int windowSize, int numBins);
+            ~RotatedOffsetTable();
+            RotatedOffsetTable(const RotatedOffsetTable&) = delete;
+            RotatedOffsetTable& operator=(const RotatedOffsetTable&) = delete;
+            int windowSize() const { return this->windowSize_; }
+            int numBins() const { return this->numBins_; }
+            const RotatedOffsets& operator[](int bin) const;
+        private:
+            int windowSize_;
+            int numBins_;
+            std::unique_ptr<std::atomic<const RotatedOffsets*>[]> grids_;
+    };
 
-    class Rotation : public Transform {
+    //the rotation helpers only, all static. Transform::rotation() is the same rotation as a value that composes & inverts.
+    class Rotation {
         public:
         static float convertToRadians(float theta);
         static const Point2f cos_sin_of_angle(float theta, bool degrees=true);
         static Point2i rotate_pt_CW(const Point2i& pt, const Point2i& center, const Point2f& angles);
         static Point2i rotate_pt_CCW(const Point2i& pt, const Point2i& center, const Point2f& angles);
         static Point2i rotate_pt_CCW(const Point2i& pt, const Point2i& center, float theta, bool degrees=true);
+        //the same rotations without truncating to int.
+        static Point2f rotate_pt_CW(const Point2f& pt, const Point2f& center, const Point2f& angles);
+        static Point2f rotate_pt_CCW(const Point2f& pt, const Point2f& center, const Point2f& angles);
         static Mat rotate_mat_CCW(Mat& I, const Point2i& center, const Point2f& angles);
-        static Mat getRotatedWindow(Mat& I, const Point2i& center, int windowSize, float theta, bool degrees=true);
+        //rotate a whole image about center, counter clockwise by the angle of angles = (cos, sin), i.e. the same mapping as
+        //rotate_mat_CCW: dst(p) = src(rotate_pt_CW(p)). 8U or 32F with 1 to 4 channels, INTER_NEAREST or INTER_LINEAR.
+        //pixels that come from outside src get borderValue. Rows are split across cores on the TaskScheduler pool, like
+        //every parallel loop of the module.
+        //multiples of 90 degrees about a pixel (or a pixel corner) skip the resampling & are copied pixel for pixel, lossless.
+        static void rotate(const Mat& src, Mat& dst, const Point2f& center, const Point2f& angles, int interpolation = INTER_LINEAR, const Scalar& borderValue = Scalar());
+        //the same result as rotate(), but dst goes in square tiles (tileSize 0 picks rotationTileSize) instead of whole rows,
+        //so a tile's source pixels stay in cache while it is written: rows of a large image turned by a large angle read
+        //src diagonally, a cache line for every few pixels. Tiles run on the TaskScheduler pool of numThreads
+        //(0 = one per core, 1 = serially on this thread). Worth it for images well beyond L2, e.g. 4K & up.
+        //tileSize is rounded up to a multiple of the SIMD width, so every pixel is sampled the same way as by rotate().
+        static void rotateTiled(const Mat& src, Mat& dst, const Point2f& center, const Point2f& angles, int interpolation = INTER_LINEAR, const Scalar& borderValue = Scalar(), int numThreads = 0, int tileSize = 0);
+        //the side of the square dst tiles rotateTiled uses for pixels of elemSize bytes.
+        static int rotationTileSize(size_t elemSize);
+        //whether angles = (cos, sin) is a multiple of 90 degrees, turns counter clockwise in [0, 4) if so.
+        static bool isQuarterTurn(const Point2f& angles, int& turns);
+        //the whole image turned counter clockwise by turns * 90 degrees, width & height swap for odd turns. Any type, lossless.
+        static void rotateQuarter(const Mat& src, Mat& dst, int turns);
+        //mirror like cv::flip: flipCode 0 upside down, > 0 left to right, < 0 both. Any type.
+        static void flip(const Mat& src, Mat& dst, int flipCode);
+        //a windowSize x windowSize window around center turned by theta, any type, nearest pixel. Whole degrees come from the
+        //cached offset grids of RotatedOffsets, other angles build a grid for the call.
+        //pixels from outside I follow borderType like copyMakeBorder (BORDER_CONSTANT with borderValue, BORDER_REPLICATE,
+        //BORDER_REFLECT, BORDER_REFLECT_101 or BORDER_WRAP), so the image never needs padding first.
+        static Mat getRotatedWindow(Mat& I, const Point2i& center, int windowSize, float theta, bool degrees=true, int borderType = BORDER_CONSTANT, const Scalar& borderValue = Scalar());
+        //every window of the array resampled to patchSize x patchSize, stacked into one (size*patchSize) x patchSize image
+        //of src's type: patch i is dst.rowRange(i*patchSize, (i+1)*patchSize). dst goes through Mat::create, so it is kept
+        //only if it already has exactly that size & type: reuse it for batches of the same number of windows.
+        //windows are split across cores, and nothing is allocated per window. Pixels from outside src get borderValue.
+        static void extractWindows(const Mat& src, const RotatedWindowArray& windows, int patchSize, Mat& dst, int interpolation = INTER_LINEAR, bool degrees = true, const Scalar& borderValue = Scalar());
         static Point drawRotated(Point& pt, Mat& src, Mat& roi_rotation_mat, bool draw=true);
+        //the same with the 2x3 matrix on the stack, e.g. from linalg::rotationMatrix2D: no allocation per point.
+        static Point drawRotated(Point& pt, Mat& src, const linalg::Mat23d& roi_rotation_mat, bool draw=true);
         static Mat doubleCrop(Mat& src, const Point2i& center, int windowSize, double angle);
     };
 } //namespace SLAM
\ No newline at end of file
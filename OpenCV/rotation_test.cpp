@@ -0,0 +1,170 @@
+#include <iostream>
+#include <string>
+#include "rotation.h"
+
+using namespace std;
+
+/*
+    Check the rotation module against OpenCV, without a window or an image file:
+    1. rotateQuarter is exactly cv::rotate & flip is exactly cv::flip, for every turn, flip code & a few pixel types
+    2. rotate() by 90, 180 & 270 degrees about a pixel center is exactly rotateQuarter
+    3. rotateTiled is exactly rotate(), serially & on the pool, with the default tile & tiles that aren't a SIMD width
+    4. rotate() is warpAffine with WARP_INVERSE_MAP up to its fixed point coordinates, for 1 to 4 channels of 8U & 32F
+    5. a getRotatedWindow over an edge or a corner is exactly the same window of the image padded by copyMakeBorder,
+       for every border type
+    Prints every failed check, returns 1 if there was one.
+
+    g++ -O2 -std=c++17 OpenCV/rotation_test.cpp OpenCV/rotation.cpp OpenCV/TaskScheduler.cpp OpenCV/Trace.cpp \
+        `pkg-config --cflags --libs opencv4` -pthread -o rotation_test
+*/
+
+using SLAM::Rotation;
+
+bool ok = true;
+
+static void check(bool passed, const std::string& what) {
+    if (!passed) {
+        cout << "FAILED: " << what << endl;
+        ok = false;
+    }
+}
+
+//a random image, odd sized & not square so a wrong transpose or off by one shows up.
+static Mat randomImage(int type, Size size = Size(37, 23)) {
+    Mat img(size, type);
+    theRNG().state = 0x1234;
+    randu(img, Scalar::all(0), Scalar::all(255));
+    return img;
+}
+
+//a smooth image, so the 1/32 pixel coordinates of warpAffine move a bilinear sample by little & a nearest pixel that
+//rounds the other way is a neighbour of about the same value: no gradient is steeper than 100/5 + 100/7 per pixel.
+static Mat smoothImage(int type, Size size) {
+    Mat img(size, CV_MAKETYPE(CV_32F, CV_MAT_CN(type)));
+    for (int y = 0; y < img.rows; ++y) {
+        float* row = img.ptr<float>(y);
+        for (int x = 0; x < img.cols; ++x) {
+            for (int c = 0; c < img.channels(); ++c) {
+                row[x*img.channels() + c] = 127.5f + 100.0f*std::sin(x/7.0f + c)*std::cos(y/5.0f - c);
+            }
+        }
+    }
+    Mat converted;
+    img.convertTo(converted, type);
+    return converted;
+}
+
+int main() {
+    const int types[] = {CV_8UC1, CV_8UC3, CV_16UC2, CV_32FC1, CV_32FC4};
+    //turns counter clockwise, like rotateQuarter.
+    const RotateFlags cvTurns[] = {ROTATE_90_COUNTERCLOCKWISE, ROTATE_180, ROTATE_90_CLOCKWISE};
+
+    for (int type : types) {
+        const Mat img = randomImage(type);
+        for (int k = 1; k <= 3; ++k) {
+            Mat ours, theirs;
+            Rotation::rotateQuarter(img, ours, k);
+            cv::rotate(img, theirs, cvTurns[k - 1]);
+            check(ours.size() == theirs.size() && norm(ours, theirs, NORM_INF) == 0,
+                  "rotateQuarter " + to_string(k) + " turns, " + typeToString(type));
+        }
+        for (int flipCode : {0, 1, -1, 2}) {
+            Mat ours, theirs;
+            Rotation::flip(img, ours, flipCode);
+            cv::flip(img, theirs, flipCode);
+            check(norm(ours, theirs, NORM_INF) == 0, "flip " + to_string(flipCode) + ", " + typeToString(type));
+        }
+    }
+
+    //square so the turned image covers dst, the center pixel of an odd side maps pixels onto pixels.
+    for (int type : {CV_8UC1, CV_8UC3, CV_32FC1, CV_32FC4}) {
+        const Mat img = randomImage(type, Size(33, 33));
+        const Point2f center(16, 16);
+        for (int k = 1; k <= 3; ++k) {
+            Mat quarter;
+            Rotation::rotateQuarter(img, quarter, k);
+            for (int interpolation : {INTER_NEAREST, INTER_LINEAR}) {
+                Mat rotated;
+                Rotation::rotate(img, rotated, center, Rotation::cos_sin_of_angle(90.0f*k), interpolation);
+                check(norm(rotated, quarter, NORM_INF) == 0, "rotate " + to_string(90*k) + " degrees"
+                      + (interpolation == INTER_LINEAR ? " bilinear, " : " nearest, ") + typeToString(type));
+            }
+        }
+    }
+
+    //an angle that resamples, & a size that leaves partial tiles & a SIMD tail on every row.
+    for (int type : {CV_8UC1, CV_8UC3, CV_32FC1, CV_32FC3}) {
+        const Mat img = randomImage(type, Size(203, 131));
+        const Point2f center(97.3f, 61.8f);
+        const Point2f angles = Rotation::cos_sin_of_angle(33.0f);
+        for (int interpolation : {INTER_NEAREST, INTER_LINEAR}) {
+            Mat rotated;
+            Rotation::rotate(img, rotated, center, angles, interpolation);
+            for (int numThreads : {1, 0}) {
+                for (int tileSize : {0, 7, 24, 50}) {
+                    Mat tiled;
+                    Rotation::rotateTiled(img, tiled, center, angles, interpolation, Scalar(), numThreads, tileSize);
+                    check(norm(tiled, rotated, NORM_INF) == 0, "rotateTiled tile " + to_string(tileSize) + ", "
+                          + to_string(numThreads) + " threads" + (interpolation == INTER_LINEAR ? " bilinear, " : " nearest, ") + typeToString(type));
+                }
+            }
+        }
+    }
+
+    //rotate() maps dst to src with sx = cx + c (x - cx) - s (y - cy), sy = cy + s (x - cx) + c (y - cy): that matrix is
+    //what warpAffine takes with WARP_INVERSE_MAP. Only the middle quarter is compared, whose source is inside src at
+    //any angle, since a border pixel that rounds the other way is off by the whole border value.
+    for (int depth : {CV_8U, CV_32F}) {
+        for (int cn = 1; cn <= 4; ++cn) {
+            const int type = CV_MAKETYPE(depth, cn);
+            const Mat img = smoothImage(type, Size(160, 120));
+            const Point2f center(79.5f, 60.25f);
+            const Rect middle(40, 30, 80, 60);
+            for (float degrees : {17.0f, 33.0f, 128.5f, 301.0f}) {
+                const Point2f angles = Rotation::cos_sin_of_angle(degrees);
+                const Matx23f inverse(angles.x, -angles.y, center.x - angles.x*center.x + angles.y*center.y,
+                                      angles.y, angles.x, center.y - angles.y*center.x - angles.x*center.y);
+                for (int interpolation : {INTER_NEAREST, INTER_LINEAR}) {
+                    Mat ours, theirs;
+                    Rotation::rotate(img, ours, center, angles, interpolation);
+                    warpAffine(img, theirs, inverse, img.size(), interpolation | WARP_INVERSE_MAP);
+                    const double maxError = norm(ours(middle), theirs(middle), NORM_INF);
+                    const double meanError = norm(ours(middle), theirs(middle), NORM_L1)/(double(middle.area())*cn);
+                    //nearest: a few pixels may take a neighbour. bilinear: 1/32 pixel of the gradient, plus rounding of 8U.
+                    const bool bilinear = interpolation == INTER_LINEAR;
+                    check(maxError <= (bilinear ? 2.0 : 40.0) && meanError <= (bilinear ? 0.5 : 1.0),
+                          "rotate vs warpAffine " + to_string(degrees) + " degrees" + (bilinear ? " bilinear, " : " nearest, ")
+                          + typeToString(type) + ": max " + to_string(maxError) + ", mean " + to_string(meanError));
+                }
+            }
+        }
+    }
+
+    //padded wide enough that the window is inside it, so the padded image takes the path without border handling.
+    const char* borderNames[] = {"CONSTANT", "REPLICATE", "REFLECT", "WRAP", "REFLECT_101"};
+    for (int type : {CV_8UC1, CV_32FC3}) {
+        const Mat img = randomImage(type);
+        const int windowSize = 15;
+        const int pad = windowSize;
+        const Scalar borderValue(7, 8, 9);
+        const Point2i centers[] = {Point2i(0, 11), Point2i(img.cols - 1, 11), Point2i(18, 0), Point2i(18, img.rows - 1),
+                                   Point2i(2, 3), Point2i(img.cols - 3, img.rows - 2)};
+        for (int borderType : {BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT, BORDER_WRAP, BORDER_REFLECT_101}) {
+            Mat padded;
+            copyMakeBorder(img, padded, pad, pad, pad, pad, borderType, borderValue);
+            for (const Point2i& center : centers) {
+                //whole degrees come from the cached grids, 47.5 builds its own.
+                for (float theta : {0.0f, 30.0f, 47.5f, 200.0f}) {
+                    Mat image = img;
+                    const Mat window = Rotation::getRotatedWindow(image, center, windowSize, theta, true, borderType, borderValue);
+                    const Mat expected = Rotation::getRotatedWindow(padded, center + Point2i(pad, pad), windowSize, theta);
+                    check(norm(window, expected, NORM_INF) == 0, std::string("getRotatedWindow BORDER_") + borderNames[borderType]
+                          + " at (" + to_string(center.x) + ", " + to_string(center.y) + "), " + to_string(theta) + " degrees, " + typeToString(type));
+                }
+            }
+        }
+    }
+
+    cout << (ok ? "all rotation checks passed" : "some rotation checks FAILED") << endl;
+    return ok ? 0 : 1;
+}
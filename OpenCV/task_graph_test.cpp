@@ -0,0 +1,42 @@
+#include <iostream>
+#include <atomic>
+#include "TaskScheduler.hpp"
+
+using namespace std;
+
+/*
+    Stress the lifetime of a TaskGraph:
+    build many short graphs on the stack, run them and destroy them straight away,
+    like ExtremaDetector::detect, TiledGaussPyramid::build & the tiled rotation do every call.
+    A worker must not touch the graph once run() has returned (best run under -fsanitize=thread or address).
+
+    g++ -O2 -std=c++17 -pthread -fsanitize=address OpenCV/TaskScheduler.cpp OpenCV/task_graph_test.cpp -o task_graph_test
+*/
+
+const int iterations = 20000;
+
+int main() {
+    TaskScheduler& scheduler = TaskScheduler::get(4);      //several workers even on small machines, so tasks really race
+    std::atomic<int> executed{0};
+    long expected = 0;
+
+    for (int i = 0; i < iterations; ++i) {
+        TaskGraph graph;
+        //a small fan-out / fan-in, so the last task to finish is a different worker every time.
+        const int fanOut = 1 + i % 4;
+        int root = graph.add([&executed]{ ++executed; });
+        int sink = graph.add([&executed]{ ++executed; });
+        for (int j = 0; j < fanOut; ++j) {
+            int mid = graph.add([&executed]{ ++executed; });
+            graph.precede(root, mid);
+            graph.precede(mid, sink);
+        }
+        graph.run(scheduler);
+        expected += fanOut + 2;
+    }
+
+    bool ok = executed == expected;
+    cout << iterations << " graphs on " << scheduler.numThreads() << " threads, "
+         << executed << " tasks run (expected " << expected << ")" << (ok ? "" : "  MISMATCH") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <cmath>
+
+using namespace cv;
+
+namespace SLAM {
+    namespace detail {
+        constexpr double pi = 3.14159265358979323846;
+
+        //taylor series, exact to double precision for |x| <= pi/2, which is all the tables need.
+        constexpr double sinSeries(double x) {
+            double term = x, sum = x;
+            for (int n = 1; n < 16; ++n) {
+                term *= -x*x/((2*n)*(2*n + 1));
+                sum += term;
+            }
+            return sum;
+        }
+
+        constexpr double cosSeries(double x) {
+            double term = 1, sum = 1;
+            for (int n = 1; n < 16; ++n) {
+                term *= -x*x/((2*n - 1)*(2*n));
+                sum += term;
+            }
+            return sum;
+        }
+    } //namespace detail
+
+    //cos & sin of Bins angles evenly spread over the circle, bin i being i*360/Bins degrees, generated at compile time.
+    //Only the first quarter turn is evaluated, the rest is the same values swapped & negated, so the quarter turns
+    //are exactly 0 & +-1 (std::cos of a float pi/2 isn't).
+    template<int Bins>
+    struct TrigLUT {
+        static_assert(Bins > 0 && Bins % 4 == 0, "the bins have to split into quarter turns");
+        static constexpr int bins = Bins;
+        float cosines[Bins] = {};
+        float sines[Bins] = {};
+
+        constexpr TrigLUT() {
+            const int quarter = Bins/4;
+            for (int i = 0; i < Bins; ++i) {
+                const int q = i/quarter;
+                const double x = 2*detail::pi*(i - q*quarter)/Bins;
+                const float c = float(detail::cosSeries(x));
+                const float s = float(detail::sinSeries(x));
+                switch (q) {
+                    case 0: this->cosines[i] = c;  this->sines[i] = s;  break;
+                    case 1: this->cosines[i] = -s; this->sines[i] = c;  break;
+                    case 2: this->cosines[i] = -c; this->sines[i] = -s; break;
+                    default: this->cosines[i] = s; this->sines[i] = -c; break;
+                }
+            }
+        }
+
+        //the nearest bin of an angle, any angle (negative, or past a full turn) wraps around.
+        static int bin(float theta, bool degrees = true) {
+            const double turns = degrees ? theta/360.0 : theta/(2*detail::pi);
+            const int i = int(std::lround(turns*Bins) % Bins);
+            return i < 0 ? i + Bins : i;
+        }
+
+        //(cos, sin) of a bin, like Rotation::cos_sin_of_angle.
+        Point2f angles(int i) const { return Point2f(this->cosines[i], this->sines[i]); }
+    };
+
+    //the two binnings orientations are quantized into: 10 degree (SIFT orientation histogram) & 1 degree bins.
+    inline constexpr TrigLUT<36> trigLUT36{};
+    inline constexpr TrigLUT<360> trigLUT360{};
+} //namespace SLAM
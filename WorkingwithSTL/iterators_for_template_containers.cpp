@@ -1,7 +1,13 @@
 #include <algorithm>
+#include <cstddef>
 #include <iostream>
+#include <iterator>
+#include <type_traits>
 #include <vector>
+#include "template_containers.hpp"
 //This folows: https://www.internalpointers.com/post/writing-custom-iterators-modern-cpp
+//template_containers.hpp also has containers that avoid allocations & bulk operations a vector register at a time,
+//see template_containers_examples.cpp.
 
 /*
     //C++ defines 6 types of iterators. These are heirarchical with #6 being at the highest level of heirarchy.
@@ -32,7 +38,9 @@
     ---------------------------------------------------------------------------
 
     Iterators (1) & (2) are often used for input and output streams [single-pass algorithms]
-    We will use a (3) Forward Iterator to work with the custom container.
+    The custom containers keep their data in one block of memory, so they use a (6) Contiguous Iterator
+    (tagged random access for C++17). A weaker tag still works for
+    loops, but e.g. std::sort needs (5), and std::distance & std::copy are only fast for (5) & (6).
 
     1. Define iterator inside the class
     2. Prepare custom iterator with tags
@@ -43,101 +51,48 @@
     ---------------------------------------------------------------------------
 */
 
+/*
+    The iterator & the containers are defined once, in template_containers.hpp, so the tutorial & the benchmarks use
+    the same code. The numbered comments there follow the steps above:
+
+    ContiguousIterator<T>   2. the tags: random access (C++17) & contiguous (C++20), since every container here keeps
+                               its data in one block of memory. With a weaker tag the STL walks the range one element
+                               at a time: std::distance is O(n), std::copy compares against end at every element
+                               instead of running a counted (vectorizable) loop, and std::sort doesn't compile at all.
+                            3. the constructors: a pointer to an element, plus the default constructor random access
+                               needs. Copying, assigning, destroying & swapping are implicitly declared.
+                               ContiguousIterator<const T> is the const iterator, an iterator converts to it.
+                            4. the operators: *, ->, [], ++ & -- (prefix & postfix), jumps & distances, == < ...
+    IntVec                  1. & 5. a wrapper around a std::vector<int> that names its Iterator & ConstIterator, and
+                               hands them out with begin() & end() (and cbegin() & cend()).
+    TempVec<X, Alloc>       the same for any element type. Alloc can be ignored here, it defaults to std::allocator.
+    NamedTemplate<T, Alloc> the preferred way: begin() & end() simply return pointers, which already are contiguous
+                               iterators, so no iterator class is needed at all.
+
+    Below are the two toy containers that only the tutorial uses, then everything in use.
+*/
+
+
 //Define some custom container, with which we will iterate over.
 //Integers class is a 'wrapper' around a raw aray of ints.              (toy example to explain concept)
 class Integers {
     public:
         //1. define iterator
-        struct Iterator { 
-            /* 
-            2. You must define properties for an iterator. 
-            note: wrong tags mean sub-optimal perforamnce, since STL uses these tags to decide which algs to use. 
-            */ 
-            using iterator_category = std::forward_iterator_tag;
-            using difference_type   = std::ptrdiff_t;
-            using value_type        = int;                          //int, since our data is an int, using other types makes the compiler skip over more or less memory.
-            using pointer           = int*;     //or also value_type*
-            using reference         = int&;     //or also value_type&
-            //3. all iterators must be constructible, copy-constructible, copy-assignable, destructible and swappable.
-            //a pointer to the container satisfies constructible, while the rest are implicitly declared.
-            Iterator(pointer ptr) : m_ptr(ptr) {}
-
-            //4. implement operators for iterator
-            reference operator*() const { return *m_ptr; }
-            pointer operator->() { return m_ptr; }
-
-            //prefix & postfix operators
-            Iterator& operator++() { m_ptr++; return *this; }
-            Iterator operator++(int) { Iterator tmp = *this; ++(*this); return tmp; }
-
-            //equality operators
-            //'friend' keyword defines operators as non-member functions which can access private members of Iterator.
-            friend bool operator== (const Iterator& a, const Iterator& b) { return a.m_ptr == b.m_ptr; };
-            friend bool operator!= (const Iterator& a, const Iterator& b) { return a.m_ptr != b.m_ptr; };
-
-            private:
-                pointer m_ptr;
-        };  //end struct iterator
+        //the shared iterator of template_containers.hpp, for int & const int.
+        using Iterator = ContiguousIterator<int>;
+        using ConstIterator = ContiguousIterator<const int>;
         //5. Add begin() and end() for creating Iterator objects.
         Iterator begin() {return Iterator(&m_data[0]);}
         Iterator end() { return Iterator(&m_data[4]);}        //note the iterator must return the position AFTER the last index value (invalid memory).
+        ConstIterator begin() const { return ConstIterator(&m_data[0]); }
+        ConstIterator end() const { return ConstIterator(&m_data[4]); }
+        ConstIterator cbegin() const { return begin(); }
+        ConstIterator cend() const { return end(); }
     private:
         int m_data[4];
 };
 
 
-//Custom wrapper with an explicitly defined iterator and type (toy example)
-class IntVec {
-    public:
-        //1. define iterator
-        IntVec() {}
-        IntVec(std::vector<int>& data): m_data(data) {}
-        struct Iterator { 
-            /* 
-            2. You must define properties for an iterator. 
-            note: wrong tags mean sub-optimal perforamnce, since STL uses these tags to decide which algs to use. 
-            */ 
-            using iterator_category = std::forward_iterator_tag;
-            using difference_type   = std::ptrdiff_t;
-            using value_type        = int;                          //int, since our data is an int, using other types makes the compiler skip over more or less memory.
-            using pointer           = int*;     //or also value_type*
-            using reference         = int&;     //or also value_type&
-            //3. all iterators must be constructible, copy-constructible, copy-assignable, destructible and swappable.
-            //a pointer to the container satisfies constructible, while the rest are implicitly declared.
-            Iterator(pointer ptr) : m_ptr(ptr) {}
-
-            //4. implement operators for iterator
-            reference operator*() const { return *m_ptr; }
-            pointer operator->() { return m_ptr; }
-
-            //prefix & postfix operators
-            Iterator& operator++() { m_ptr++; return *this; }
-            Iterator operator++(int) { Iterator tmp = *this; ++(*this); return tmp; }
-
-            //equality operators
-            //'friend' keyword defines operators as non-member functions which can access private members of Iterator.
-            friend bool operator== (const Iterator& a, const Iterator& b) { return a.m_ptr == b.m_ptr; };
-            friend bool operator!= (const Iterator& a, const Iterator& b) { return a.m_ptr != b.m_ptr; };
-
-            private:
-                pointer m_ptr;
-        };
-
-        //5. Add begin() and end() for creating Iterator objects.
-        //convert references to pointers:
-        //https://stackoverflow.com/questions/19032461/convert-reference-to-pointer-representation-in-c
-        Iterator begin() {return Iterator( std::addressof(m_data.front()) );}
-        Iterator end() {
-             Iterator::pointer back = std::addressof(m_data.back());
-             ++back;
-            return Iterator(back); //more general than choosing an index, but needs to be incremented.
-        }         
-        std::vector<int>& vector() { return m_data; }
-    private:
-        std::vector<int> m_data = {};        
-};
-
-
 //If your class is a wrapper of a std lib datastruct, you can just pass the iterator (toy example)
 class Doubles {
     using DoublesType = std::vector<double>;
@@ -151,87 +106,6 @@ class Doubles {
 };
 
 
-//now, try it with template classes
-/*
-    Template parameters on a function either have to be explicitly provided OR
-    have to be deductible from the function parameters
-    iterators have a value_type member
-*/
-
-
-//Templated custom container using a templated datatype on stl datastructure with explicit iterator implementation 
-template <typename X>
-class TempVec {
-    public:
-        //1. define iterator
-        TempVec() {}
-        TempVec(std::vector<X>& data): m_data(data) {}
-        struct Iterator { 
-            /* 
-            2. You must define properties for an iterator. 
-            note: wrong tags mean sub-optimal perforamnce, since STL uses these tags to decide which algs to use. 
-            */ 
-            using iterator_category = std::forward_iterator_tag;
-            using difference_type   = std::ptrdiff_t;
-            using value_type        = X;                          //int, since our data is an int, using other types makes the compiler skip over more or less memory.
-            using pointer           = X*;     //or also value_type*
-            using reference         = X&;     //or also value_type&
-            //3. all iterators must be constructible, copy-constructible, copy-assignable, destructible and swappable.
-            //a pointer to the container satisfies constructible, while the rest are implicitly declared.
-            Iterator(pointer ptr) : m_ptr(ptr) {}
-
-            //4. implement operators for iterator
-            reference operator*() const { return *m_ptr; }
-            pointer operator->() { return m_ptr; }
-
-            //prefix & postfix operators
-            Iterator& operator++() { m_ptr++; return *this; }
-            Iterator operator++(int) { Iterator tmp = *this; ++(*this); return tmp; }
-
-            //equality operators
-            //'friend' keyword defines operators as non-member functions which can access private members of Iterator.
-            friend bool operator== (const Iterator& a, const Iterator& b) { return a.m_ptr == b.m_ptr; };
-            friend bool operator!= (const Iterator& a, const Iterator& b) { return a.m_ptr != b.m_ptr; };
-
-            private:
-                pointer m_ptr;
-        };  //end struct iterator
-        //5. Add begin() and end() for creating Iterator objects.
-        //convert references to pointers:
-        //https://stackoverflow.com/questions/19032461/convert-reference-to-pointer-representation-in-c
-        Iterator begin() {return Iterator( std::addressof(m_data.front()) );}
-        Iterator end() {
-            //Rvalue incrementing is not valid in C++. It must be done on a lvalue variable.
-            //https://stackoverflow.com/questions/53985228/why-is-rvalue-incrementing-in-c-illegal
-            //use template type as a pointer.
-            X* back = std::addressof(m_data.back());
-            ++back;
-            return Iterator(back);
-        }         //more general than choosing an index, but needs to be incremented.
-        std::vector<X>& vector() { return m_data; }
-    private:
-        std::vector<X> m_data = {};        
-};
-
-
-// ------------------------- A simplified iterable custom container with templated data type (preferred) -------------------------
-template <typename T>
-struct NamedTemplate {
-    public:
-        NamedTemplate() {}
-        NamedTemplate(std::vector<T> data) : m_data(data) {}
-        //Overriding the begin and end functions for the stl library doesn't require an iterator explicity. It can just be a pointer.
-        T* begin() { return std::addressof(m_data.front()); }
-        T* end() { 
-            T* back = std::addressof(m_data.back());
-            ++back;
-            return back;
-        }
-     private:
-        std::vector<T> m_data = std::vector<T>(0);
-};
-
-
 int main() {
     
     //------------------------- default iterator w/ std container -------------------------
@@ -280,6 +154,15 @@ int main() {
         std::cout << "range-for loop with custom iterator: " << i << "\n";
     }
 
+    //random access: jumps, distances & the algorithms that need them.
+    std::sort(tempInt.begin(), tempInt.end(), std::greater<int>());
+    std::cout << "sorted descending, " << std::distance(tempInt.begin(), tempInt.end()) << " elements, the third is " << tempInt.begin()[2] << "\n";
+    //a const container hands out const iterators, *it can't be assigned to.
+    const IntVec& constInt = tempInt;
+    IntVec::ConstIterator first = constInt.begin();
+    IntVec::ConstIterator last = constInt.end() - 1;
+    std::cout << "first " << *first << ", last " << *last << ", " << last - first << " apart\n";
+
     //another wrapper w/ different type
     Doubles doubles = Doubles({5.0, 6.0, 7.0, 8.0});
 
@@ -320,7 +203,8 @@ int main() {
     for (auto i : int_obj2) {
         std::cout << i << "\n";
     }
-    
+
+
     return 0;
 }
 
@@ -0,0 +1,687 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+//This folows: https://www.internalpointers.com/post/writing-custom-iterators-modern-cpp
+//The custom iterator & containers, defined only here: iterators_for_template_containers.cpp walks through them step by
+//step (the numbered comments), the benchmarks use them with allocators. Plus containers without a heap allocation per
+//list & bulk operations, see template_containers_examples.cpp for how those are used.
+
+//The iterator shared by the containers below. They all keep their data in one block of memory, so the right tag is
+//the strongest one: random access (C++17), and contiguous on top of that with C++20. With a weaker tag the STL walks
+//the range one element at a time: std::distance is O(n), std::copy compares against end at every element instead of
+//running a counted (vectorizable) loop, and std::sort doesn't compile at all.
+//T is the element type, const T makes the const iterator.
+template <typename T>
+struct ContiguousIterator {
+    /*
+    2. You must define properties for an iterator.
+    note: wrong tags mean sub-optimal perforamnce, since STL uses these tags to decide which algs to use.
+    */
+    using iterator_category = std::random_access_iterator_tag;
+#if __cplusplus > 201703L
+    using iterator_concept  = std::contiguous_iterator_tag;     //C++20: lets std::to_address & the ranges algorithms see the raw pointer.
+#endif
+    using difference_type   = std::ptrdiff_t;
+    using value_type        = std::remove_cv_t<T>;              //never const, even for the const iterator.
+    using pointer           = T*;
+    using reference         = T&;
+    //3. all iterators must be constructible, copy-constructible, copy-assignable, destructible and swappable.
+    //random access ones also default constructible.
+    ContiguousIterator() = default;
+    ContiguousIterator(pointer ptr) : m_ptr(ptr) {}
+    //an iterator converts to a const iterator, not the other way around.
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+    ContiguousIterator(const ContiguousIterator<U>& other) : m_ptr(other.operator->()) {}
+
+    //4. implement operators for iterator
+    reference operator*() const { return *m_ptr; }
+    pointer operator->() const { return m_ptr; }
+    reference operator[](difference_type n) const { return m_ptr[n]; }
+
+    //prefix & postfix operators, both directions
+    ContiguousIterator& operator++() { m_ptr++; return *this; }
+    ContiguousIterator operator++(int) { ContiguousIterator tmp = *this; ++(*this); return tmp; }
+    ContiguousIterator& operator--() { m_ptr--; return *this; }
+    ContiguousIterator operator--(int) { ContiguousIterator tmp = *this; --(*this); return tmp; }
+
+    //jumps & distances
+    ContiguousIterator& operator+=(difference_type n) { m_ptr += n; return *this; }
+    ContiguousIterator& operator-=(difference_type n) { m_ptr -= n; return *this; }
+    friend ContiguousIterator operator+(ContiguousIterator it, difference_type n) { return it += n; }
+    friend ContiguousIterator operator+(difference_type n, ContiguousIterator it) { return it += n; }
+    friend ContiguousIterator operator-(ContiguousIterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const ContiguousIterator& a, const ContiguousIterator& b) { return a.m_ptr - b.m_ptr; }
+
+    //equality & ordering operators
+    //'friend' keyword defines operators as non-member functions which can access private members of Iterator.
+    friend bool operator== (const ContiguousIterator& a, const ContiguousIterator& b) { return a.m_ptr == b.m_ptr; };
+    friend bool operator!= (const ContiguousIterator& a, const ContiguousIterator& b) { return a.m_ptr != b.m_ptr; };
+    friend bool operator< (const ContiguousIterator& a, const ContiguousIterator& b) { return a.m_ptr < b.m_ptr; };
+    friend bool operator> (const ContiguousIterator& a, const ContiguousIterator& b) { return a.m_ptr > b.m_ptr; };
+    friend bool operator<= (const ContiguousIterator& a, const ContiguousIterator& b) { return a.m_ptr <= b.m_ptr; };
+    friend bool operator>= (const ContiguousIterator& a, const ContiguousIterator& b) { return a.m_ptr >= b.m_ptr; };
+
+    private:
+        pointer m_ptr = nullptr;
+};
+
+//Custom wrapper with an explicitly defined iterator and type (toy example)
+class IntVec {
+    public:
+        //1. define iterator
+        IntVec() {}
+        IntVec(std::vector<int>& data): m_data(data) {}
+        IntVec(std::vector<int>&& data): m_data(std::move(data)) {}     //takes over the vector's memory, no copy.
+        //the shared iterator above, for int & const int.
+        using Iterator = ContiguousIterator<int>;
+        using ConstIterator = ContiguousIterator<const int>;
+
+        //5. Add begin() and end() for creating Iterator objects.
+        //data() rather than std::addressof(m_data.front()): front() & back() of an empty vector are undefined, data() + size() is always valid.
+        Iterator begin() { return Iterator(m_data.data()); }
+        Iterator end() { return Iterator(m_data.data() + m_data.size()); }
+        ConstIterator begin() const { return ConstIterator(m_data.data()); }
+        ConstIterator end() const { return ConstIterator(m_data.data() + m_data.size()); }
+        ConstIterator cbegin() const { return begin(); }
+        ConstIterator cend() const { return end(); }
+        std::vector<int>& vector() { return m_data; }
+    private:
+        std::vector<int> m_data = {};        
+};
+
+
+//now, try it with template classes
+/*
+    Template parameters on a function either have to be explicitly provided OR
+    have to be deductible from the function parameters
+    iterators have a value_type member
+*/
+
+
+//Templated custom container using a templated datatype on stl datastructure with explicit iterator implementation 
+//Alloc is where the elements live, e.g. std::pmr::polymorphic_allocator<X> (see PmrTempVec below) to put them in an arena.
+template <typename X, typename Alloc = std::allocator<X>>
+class TempVec {
+    public:
+        //1. define iterator
+        TempVec() {}
+        explicit TempVec(const Alloc& alloc) : m_data(alloc) {}
+        TempVec(const std::vector<X, Alloc>& data): m_data(data) {}
+        TempVec(std::vector<X, Alloc>&& data): m_data(std::move(data)) {}      //takes over the vector's memory, no copy.
+        //a copy of data in memory from alloc, whatever data's own allocator.
+        template <typename A>
+        TempVec(const std::vector<X, A>& data, const Alloc& alloc) : m_data(data.begin(), data.end(), alloc) {}
+        //the shared iterator above, for X & const X.
+        using Iterator = ContiguousIterator<X>;
+        using ConstIterator = ContiguousIterator<const X>;
+        //5. Add begin() and end() for creating Iterator objects.
+        //as in IntVec, data() + size() is valid for an empty vector too.
+        Iterator begin() { return Iterator(m_data.data()); }
+        Iterator end() { return Iterator(m_data.data() + m_data.size()); }
+        ConstIterator begin() const { return ConstIterator(m_data.data()); }
+        ConstIterator end() const { return ConstIterator(m_data.data() + m_data.size()); }
+        ConstIterator cbegin() const { return begin(); }
+        ConstIterator cend() const { return end(); }
+        std::vector<X, Alloc>& vector() { return m_data; }
+        Alloc get_allocator() const { return m_data.get_allocator(); }
+    private:
+        std::vector<X, Alloc> m_data = {};
+};
+
+
+// ------------------------- A simplified iterable custom container with templated data type (preferred) -------------------------
+template <typename T, typename Alloc = std::allocator<T>>
+struct NamedTemplate {
+    public:
+        NamedTemplate() {}
+        explicit NamedTemplate(const Alloc& alloc) : m_data(alloc) {}
+        //by value & moved in: an lvalue is copied once, a temporary or std::move(v) not at all.
+        NamedTemplate(std::vector<T, Alloc> data) : m_data(std::move(data)) {}
+        //a copy of data in memory from alloc, whatever data's own allocator.
+        template <typename A>
+        NamedTemplate(const std::vector<T, A>& data, const Alloc& alloc) : m_data(data.begin(), data.end(), alloc) {}
+        //Overriding the begin and end functions for the stl library doesn't require an iterator explicity. It can just be a pointer.
+        //a pointer is a contiguous iterator, so the parallel algorithms (std::execution::par / par_unseq) split it up
+        //like a std::vector. data() + size() is valid for an empty vector too, front() & back() aren't.
+        T* begin() { return m_data.data(); }
+        T* end() { return m_data.data() + m_data.size(); }
+        const T* begin() const { return m_data.data(); }
+        const T* end() const { return m_data.data() + m_data.size(); }
+        size_t size() const { return m_data.size(); }
+        Alloc get_allocator() const { return m_data.get_allocator(); }
+     private:
+        std::vector<T, Alloc> m_data = std::vector<T, Alloc>(0);
+};
+
+
+// ------------------------- Containers without a heap allocation per container -------------------------
+/*
+    Building thousands of short lists per frame (keypoints per cell, matches per keypoint) with std::vector is a
+    malloc & free per list per frame. Two ways around it:
+    1. an arena: the containers above with a std::pmr allocator, their memory comes from a FrameArena (or any
+       std::pmr::memory_resource) that is reset once per frame instead of freeing every list.
+    2. SmallVec: the first N elements live inside the object itself, only longer lists allocate.
+*/
+
+//A monotonic arena for per-frame data: allocating bumps a pointer, deallocating does nothing, and reset() frees
+//everything at once. Unlike std::pmr::monotonic_buffer_resource::release(), reset() keeps the memory (merged into one
+//block), so after the first frames the arena is as big as a frame needs & never allocates again.
+//Not thread safe, use one arena per thread.
+class FrameArena : public std::pmr::memory_resource {
+    public:
+        explicit FrameArena(size_t initialSize = 64*1024) : m_initialSize(std::max<size_t>(initialSize, 64)) {}
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+        //everything allocated so far is gone (no destructors run), the memory stays for the next frame.
+        void reset() {
+            if (m_blocks.size() > 1) {
+                const size_t total = capacity();
+                m_blocks.clear();
+                m_blocks.push_back(Block{std::unique_ptr<std::byte[]>(new std::byte[total]), total});
+            }
+            m_current = 0;
+            m_offset = 0;
+        }
+        size_t capacity() const {
+            size_t total = 0;
+            for (const Block& block : m_blocks) {
+                total += block.size;
+            }
+            return total;
+        }
+        size_t numBlocks() const { return m_blocks.size(); }
+    private:
+        struct Block {
+            std::unique_ptr<std::byte[]> data;
+            size_t size;
+        };
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            while (true) {
+                if (m_current < m_blocks.size()) {
+                    Block& block = m_blocks[m_current];
+                    const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+                    const size_t aligned = ((base + m_offset + alignment - 1) & ~uintptr_t(alignment - 1)) - base;
+                    if (aligned + bytes <= block.size) {
+                        m_offset = aligned + bytes;
+                        return block.data.get() + aligned;
+                    }
+                    if (m_current + 1 < m_blocks.size()) {
+                        ++m_current;
+                        m_offset = 0;
+                        continue;
+                    }
+                }
+                //full: a new block, twice the last one (& big enough for this allocation).
+                const size_t size = std::max(m_blocks.empty() ? m_initialSize : 2*m_blocks.back().size, bytes + alignment);
+                m_blocks.push_back(Block{std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+                m_current = m_blocks.size() - 1;
+                m_offset = 0;
+            }
+        }
+        void do_deallocate(void*, size_t, size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+        size_t m_initialSize;
+        std::vector<Block> m_blocks;
+        size_t m_current = 0;           //the block allocations come from.
+        size_t m_offset = 0;            //bytes used in it.
+};
+
+
+//A vector that keeps up to N elements inline, in the object itself: no allocation at all for short lists. Beyond N
+//the elements move to memory from Alloc & it grows like std::vector. Iterates with the same ContiguousIterator.
+template <typename T, size_t N, typename Alloc = std::allocator<T>>
+class SmallVec {
+    static_assert(N > 0, "use a std::vector for no inline elements");
+    using Traits = std::allocator_traits<Alloc>;
+    public:
+        using value_type = T;
+        using allocator_type = Alloc;
+        using Iterator = ContiguousIterator<T>;
+        using ConstIterator = ContiguousIterator<const T>;
+
+        SmallVec() {}
+        explicit SmallVec(const Alloc& alloc) : m_alloc(alloc) {}
+        SmallVec(std::initializer_list<T> values, const Alloc& alloc = Alloc()) : m_alloc(alloc) {
+            reserve(values.size());
+            for (const T& v : values) {
+                push_back(v);
+            }
+        }
+        SmallVec(const SmallVec& other) : m_alloc(Traits::select_on_container_copy_construction(other.m_alloc)) {
+            reserve(other.size());
+            for (const T& v : other) {
+                push_back(v);
+            }
+        }
+        //like std::vector, the allocator comes along. Heap elements are taken over, inline ones moved one by one.
+        SmallVec(SmallVec&& other) noexcept(std::is_nothrow_move_constructible_v<T>) : m_alloc(std::move(other.m_alloc)) {
+            takeFrom(other);
+        }
+        SmallVec& operator=(const SmallVec& other) {
+            if (this != &other) {
+                clear();
+                reserve(other.size());
+                for (const T& v : other) {
+                    push_back(v);
+                }
+            }
+            return *this;
+        }
+        SmallVec& operator=(SmallVec&& other) {
+            if (this != &other) {
+                clear();
+                if (Traits::propagate_on_container_move_assignment::value || m_alloc == other.m_alloc) {
+                    release();
+                    if constexpr (Traits::propagate_on_container_move_assignment::value) {
+                        m_alloc = std::move(other.m_alloc);
+                    }
+                    takeFrom(other);
+                }
+                else {
+                    //another arena: the elements have to be moved into ours.
+                    reserve(other.size());
+                    for (T& v : other) {
+                        push_back(std::move(v));
+                    }
+                    other.clear();
+                }
+            }
+            return *this;
+        }
+        ~SmallVec() {
+            clear();
+            release();
+        }
+
+        //5. Add begin() and end() for creating Iterator objects.
+        Iterator begin() { return Iterator(m_begin); }
+        Iterator end() { return Iterator(m_begin + m_size); }
+        ConstIterator begin() const { return ConstIterator(m_begin); }
+        ConstIterator end() const { return ConstIterator(m_begin + m_size); }
+        ConstIterator cbegin() const { return begin(); }
+        ConstIterator cend() const { return end(); }
+
+        T* data() { return m_begin; }
+        const T* data() const { return m_begin; }
+        T& operator[](size_t i) { return m_begin[i]; }
+        const T& operator[](size_t i) const { return m_begin[i]; }
+        T& back() { return m_begin[m_size - 1]; }
+        size_t size() const { return m_size; }
+        size_t capacity() const { return m_capacity; }
+        bool empty() const { return m_size == 0; }
+        //still in the inline buffer, nothing allocated.
+        bool isInline() const { return m_begin == inlineData(); }
+        Alloc get_allocator() const { return m_alloc; }
+
+        void reserve(size_t capacity) {
+            if (capacity > m_capacity) {
+                grow(capacity);
+            }
+        }
+        template <typename... Args>
+        T& emplace_back(Args&&... args) {
+            if (m_size == m_capacity) {
+                return growAndEmplace(std::forward<Args>(args)...);
+            }
+            T* slot = ::new (static_cast<void*>(m_begin + m_size)) T(std::forward<Args>(args)...);
+            ++m_size;
+            return *slot;
+        }
+        void push_back(const T& v) { emplace_back(v); }
+        void push_back(T&& v) { emplace_back(std::move(v)); }
+        void pop_back() { m_begin[--m_size].~T(); }
+        //destroys the elements, keeps the memory.
+        void clear() {
+            std::destroy(m_begin, m_begin + m_size);
+            m_size = 0;
+        }
+    private:
+        T* inlineData() { return reinterpret_cast<T*>(m_inline); }
+        const T* inlineData() const { return reinterpret_cast<const T*>(m_inline); }
+        //moves the elements to capacity from the allocator.
+        void grow(size_t capacity) {
+            moveTo(Traits::allocate(m_alloc, capacity), capacity);
+        }
+        //emplace_back on a full vector. args may refer to one of our own elements (v.push_back(v[0])), like with
+        //std::vector that has to work: the new element is built in the new memory first, while the old elements
+        //are still intact, and only then are they moved over.
+        template <typename... Args>
+        T& growAndEmplace(Args&&... args) {
+            const size_t capacity = 2*m_capacity;
+            T* data = Traits::allocate(m_alloc, capacity);
+            T* slot = nullptr;
+            try {
+                slot = ::new (static_cast<void*>(data + m_size)) T(std::forward<Args>(args)...);
+            }
+            catch (...) {
+                Traits::deallocate(m_alloc, data, capacity);
+                throw;
+            }
+            moveTo(data, capacity);
+            ++m_size;
+            return *slot;
+        }
+        //moves the elements to data (capacity elements from our allocator) & frees the old memory.
+        void moveTo(T* data, size_t capacity) {
+            for (size_t i = 0; i < m_size; ++i) {
+                ::new (static_cast<void*>(data + i)) T(std::move_if_noexcept(m_begin[i]));
+            }
+            std::destroy(m_begin, m_begin + m_size);
+            release();
+            m_begin = data;
+            m_capacity = capacity;
+        }
+        //gives heap memory back (the elements must be destroyed already), back to the inline buffer.
+        void release() {
+            if (!isInline()) {
+                Traits::deallocate(m_alloc, m_begin, m_capacity);
+                m_begin = inlineData();
+                m_capacity = N;
+            }
+        }
+        //other's elements, with this empty & inline and other's memory from our allocator. other ends up empty.
+        void takeFrom(SmallVec& other) {
+            if (other.isInline()) {
+                for (size_t i = 0; i < other.m_size; ++i) {
+                    ::new (static_cast<void*>(inlineData() + i)) T(std::move(other.m_begin[i]));
+                }
+                m_size = other.m_size;
+                other.clear();
+            }
+            else {
+                m_begin = other.m_begin;
+                m_size = other.m_size;
+                m_capacity = other.m_capacity;
+                other.m_begin = other.inlineData();
+                other.m_size = 0;
+                other.m_capacity = N;
+            }
+        }
+
+        alignas(T) unsigned char m_inline[N*sizeof(T)];
+        T* m_begin = inlineData();
+        size_t m_size = 0;
+        size_t m_capacity = N;
+        Alloc m_alloc;
+};
+
+
+//the containers with their memory from a std::pmr::memory_resource (e.g. a FrameArena), like std::pmr::vector:
+//    FrameArena arena;
+//    PmrTempVec<float> responses(&arena);
+//a copy of one of these is back on the default resource (polymorphic_allocator doesn't propagate on copy), so
+//construct each container with the arena rather than copying a prototype.
+//(not a namespace pmr, that would be ambiguous with std::pmr after a 'using namespace std'.)
+template <typename X>
+using PmrTempVec = TempVec<X, std::pmr::polymorphic_allocator<X>>;
+template <typename T>
+using PmrNamedTemplate = NamedTemplate<T, std::pmr::polymorphic_allocator<T>>;
+template <typename T, size_t N>
+using PmrSmallVec = SmallVec<T, N, std::pmr::polymorphic_allocator<T>>;
+
+
+// ------------------------- Chunked iteration: SIMD width blocks -------------------------
+/*
+    The iterators above step one element at a time, and that's all the STL algorithms see. The compiler vectorizes
+    copies & fills like that, but not a float sum or min: std::accumulate has to add in order, one element after the
+    other, and vectorizing changes that order (only -ffast-math allows it).
+    Chunks splits a contiguous range into
+        head:   the few elements before the first address aligned to the vector register width
+        blocks: lanes() elements each, aligned
+        tail:   what's left, less than a block
+    A loop over a block has a fixed trip count & aligned loads, and an accumulator per lane keeps the lanes independent.
+    fill & transform vectorize like that at -O2 & -O3. A sum or min / max over lane accumulators doesn't reliably: at -O3
+    GCC unrolls the lane loop completely before the vectorizer sees it & emits one scalar add per lane. So with GCC &
+    Clang those hold a whole register in a vector type (vector_size, see Packed below), whose + and < are the packed
+    instructions at any optimization level. Still no intrinsics, other compilers get the lane loops.
+*/
+
+//the widest vector register the build targets, in bytes: -mavx512f, -mavx / -march=native on a recent x86, SSE or NEON otherwise.
+#if defined(__AVX512F__)
+constexpr size_t simdBytes = 64;
+#elif defined(__AVX__)
+constexpr size_t simdBytes = 32;
+#else
+constexpr size_t simdBytes = 16;
+#endif
+
+//elements of T per register, 1 (no blocks) for types that don't pack into one.
+template <typename T>
+constexpr size_t simdLanes = sizeof(T) <= simdBytes && simdBytes % sizeof(T) == 0 ? simdBytes/sizeof(T) : 1;
+
+//the raw pointer of a container position, ContiguousIterator or pointer.
+template <typename T>
+T* toAddress(T* p) { return p; }
+template <typename T>
+T* toAddress(const ContiguousIterator<T>& it) { return it.operator->(); }
+
+template <typename T>
+class Chunks {
+    public:
+        static constexpr size_t lanes() { return simdLanes<std::remove_cv_t<T>>; }
+
+        //a run of elements: the head & the tail.
+        struct Run {
+            T* first;
+            T* last;
+            T* begin() const { return first; }
+            T* end() const { return last; }
+            size_t size() const { return size_t(last - first); }
+        };
+        //lanes() elements at an address aligned to simdBytes.
+        struct Block {
+            T* data;
+            T& operator[](size_t i) const { return data[i]; }
+            static constexpr size_t size() { return lanes(); }
+        };
+        struct BlockIterator {
+            T* p;
+            Block operator*() const { return Block{assumeAligned(p)}; }
+            BlockIterator& operator++() { p += lanes(); return *this; }
+            friend bool operator==(const BlockIterator& a, const BlockIterator& b) { return a.p == b.p; }
+            friend bool operator!=(const BlockIterator& a, const BlockIterator& b) { return a.p != b.p; }
+        };
+        struct Blocks {
+            BlockIterator first;
+            BlockIterator last;
+            BlockIterator begin() const { return first; }
+            BlockIterator end() const { return last; }
+            size_t size() const { return size_t(last.p - first.p)/lanes(); }
+        };
+
+        Chunks(T* first, T* last) : m_first(first), m_last(last) {
+            const size_t n = size_t(last - first);
+            //elements up to the next aligned address, or all of them if no element ever lands on one.
+            const size_t misalign = reinterpret_cast<uintptr_t>(first) % simdBytes;
+            const size_t gap = (simdBytes - misalign) % simdBytes;
+            const size_t head = lanes() == 1 || gap % sizeof(T) != 0 ? n : std::min(n, gap/sizeof(T));
+            m_blocksBegin = first + head;
+            m_blocksEnd = m_blocksBegin + (n - head)/lanes()*lanes();
+        }
+        Run head() const { return Run{m_first, m_blocksBegin}; }
+        Blocks blocks() const { return Blocks{BlockIterator{m_blocksBegin}, BlockIterator{m_blocksEnd}}; }
+        Run tail() const { return Run{m_blocksEnd, m_last}; }
+    private:
+        static T* assumeAligned(T* p) {
+#if defined(__GNUC__)
+            return static_cast<T*>(__builtin_assume_aligned(p, simdBytes));
+#else
+            return p;
+#endif
+        }
+
+        T* m_first;
+        T* m_last;
+        T* m_blocksBegin;
+        T* m_blocksEnd;
+};
+
+//the chunks of any of the containers above, const ones give const elements.
+template <typename Container>
+auto chunks(Container& c) {
+    auto* first = toAddress(c.begin());
+    return Chunks<std::remove_pointer_t<decltype(first)>>(first, toAddress(c.end()));
+}
+
+
+//Bulk operations over a whole container, a vector register at a time.
+namespace bulk {
+    template <typename Container>
+    using ValueType = std::remove_cv_t<std::remove_pointer_t<decltype(toAddress(std::declval<Container&>().begin()))>>;
+
+#if defined(__GNUC__)
+    //a block of T as one GCC / Clang vector: arithmetic on it is element wise, in one register.
+    template <typename T>
+    struct Packed {
+        typedef T type __attribute__((vector_size(simdBytes)));
+        static type load(const T* p) {
+            type v;
+            std::memcpy(&v, p, sizeof(v));      //p is aligned, so this is one aligned load.
+            return v;
+        }
+    };
+    //the element types a vector can hold, packed into more than one lane.
+    template <typename T>
+    constexpr bool packable = simdLanes<T> > 1 && !std::is_same_v<T, bool> &&
+                              (std::is_integral_v<T> || std::is_same_v<T, float> || std::is_same_v<T, double>);
+#endif
+
+    template <typename Container>
+    void fill(Container& c, const ValueType<Container>& value) {
+        auto parts = chunks(c);
+        for (auto& v : parts.head()) {
+            v = value;
+        }
+        for (auto block : parts.blocks()) {
+            for (size_t i = 0; i < block.size(); ++i) {
+                block[i] = value;
+            }
+        }
+        for (auto& v : parts.tail()) {
+            v = value;
+        }
+    }
+
+    //dst[i] = op(src[i]) for every element of src, dst has to be at least as long. dst may be src. The blocks are
+    //aligned on dst, src is read wherever it is.
+    template <typename Src, typename Dst, typename Op>
+    void transform(const Src& src, Dst& dst, Op op) {
+        const auto* in = toAddress(src.begin());
+        auto* out = toAddress(dst.begin());
+        const auto parts = Chunks<std::remove_pointer_t<decltype(out)>>(out, out + (toAddress(src.end()) - in));
+        size_t i = 0;
+        for (auto& v : parts.head()) {
+            v = op(in[i++]);
+        }
+        for (auto block : parts.blocks()) {
+            for (size_t k = 0; k < block.size(); ++k) {
+                block[k] = op(in[i + k]);
+            }
+            i += block.size();
+        }
+        for (auto& v : parts.tail()) {
+            v = op(in[i++]);
+        }
+    }
+
+    //a partial sum per lane, added up at the end: like std::reduce, floats come out slightly different from a
+    //std::accumulate in order. Acc is what's summed in, e.g. double for floats or int64_t for bytes.
+    template <typename Container, typename Acc = ValueType<Container>>
+    Acc sum(const Container& c, Acc init = Acc()) {
+        const auto parts = chunks(c);
+        constexpr size_t lanes = decltype(parts)::lanes();
+        Acc lane[lanes] = {};
+        for (const auto& v : parts.head()) {
+            init += v;
+        }
+#if defined(__GNUC__)
+        if constexpr (packable<ValueType<Container>> && std::is_same_v<Acc, ValueType<Container>>) {
+            using P = Packed<Acc>;
+            typename P::type acc = {};
+            for (auto block : parts.blocks()) {
+                acc += P::load(block.data);
+            }
+            for (size_t i = 0; i < lanes; ++i) {
+                lane[i] = acc[i];
+            }
+        }
+        else
+#endif
+        {
+            for (auto block : parts.blocks()) {
+                for (size_t i = 0; i < lanes; ++i) {
+                    lane[i] += block[i];
+                }
+            }
+        }
+        for (const auto& v : parts.tail()) {
+            init += v;
+        }
+        for (size_t i = 0; i < lanes; ++i) {
+            init += lane[i];
+        }
+        return init;
+    }
+
+    //the smallest & largest element, c must not be empty. A min & max per lane, no NaNs expected (like std::min they'd
+    //be kept or dropped depending on where they are).
+    template <typename Container>
+    std::pair<ValueType<Container>, ValueType<Container>> minMax(const Container& c) {
+        using T = ValueType<Container>;
+        const auto parts = chunks(c);
+        constexpr size_t lanes = decltype(parts)::lanes();
+        T lo = *toAddress(c.begin());
+        T hi = lo;
+        T laneLo[lanes], laneHi[lanes];
+        std::fill(laneLo, laneLo + lanes, lo);
+        std::fill(laneHi, laneHi + lanes, hi);
+        for (const T& v : parts.head()) {
+            lo = v < lo ? v : lo;
+            hi = hi < v ? v : hi;
+        }
+#if defined(__GNUC__)
+        if constexpr (packable<T>) {
+            using P = Packed<T>;
+            typename P::type vecLo = P::load(laneLo), vecHi = P::load(laneHi);
+            for (auto block : parts.blocks()) {
+                const typename P::type v = P::load(block.data);
+                vecLo = v < vecLo ? v : vecLo;
+                vecHi = vecHi < v ? v : vecHi;
+            }
+            for (size_t i = 0; i < lanes; ++i) {
+                laneLo[i] = vecLo[i];
+                laneHi[i] = vecHi[i];
+            }
+        }
+        else
+#endif
+        {
+            for (auto block : parts.blocks()) {
+                for (size_t i = 0; i < lanes; ++i) {
+                    laneLo[i] = block[i] < laneLo[i] ? block[i] : laneLo[i];
+                    laneHi[i] = laneHi[i] < block[i] ? block[i] : laneHi[i];
+                }
+            }
+        }
+        for (const T& v : parts.tail()) {
+            lo = v < lo ? v : lo;
+            hi = hi < v ? v : hi;
+        }
+        for (size_t i = 0; i < lanes; ++i) {
+            lo = laneLo[i] < lo ? laneLo[i] : lo;
+            hi = hi < laneHi[i] ? laneHi[i] : hi;
+        }
+        return {lo, hi};
+    }
+} //namespace bulk
@@ -0,0 +1,58 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "template_containers.hpp"
+
+/*
+    The containers of template_containers.hpp beyond iterating (see iterators_for_template_containers.cpp for that):
+    1. lists without a heap allocation per list: moving data in, a per frame arena & SmallVec
+    2. chunks & the bulk operations, a vector register at a time
+*/
+
+int main() {
+
+    //------------------- without an allocation per container ------------------
+    //moving a vector in hands its memory over instead of copying it.
+    std::vector<int> keypoints = {3, 1, 2};
+    TempVec<int> moved{std::move(keypoints)};
+    std::cout << "moved in " << moved.vector().size() << " elements, the vector is left with " << keypoints.size() << "\n";
+
+    //an arena per frame: every list below takes its memory from it, reset() frees all of them at once & keeps the memory.
+    FrameArena arena;
+    for (int frame = 0; frame < 3; ++frame) {
+        arena.reset();
+        PmrTempVec<float> responses(&arena);
+        for (int i = 0; i < 1000; ++i) {
+            responses.vector().push_back(i*0.5f);
+        }
+        std::cout << "frame " << frame << ": " << responses.vector().size() << " responses in an arena of " << arena.capacity() << " bytes\n";
+    }
+
+    //short lists stay inside the object.
+    SmallVec<int, 8> cell = {7, 8, 9};
+    std::cout << "small list of " << cell.size() << (cell.isInline() ? ", inline" : ", on the heap") << "\n";
+    //like std::vector, pushing one of its own elements works even when that moves everything to the heap.
+    SmallVec<std::string, 2> names = {"left", "right"};
+    names.push_back(names[0]);
+    std::cout << "grew to " << names.size() << (names.isInline() ? ", inline" : ", on the heap") << ", the copy is '" << names[2] << "'\n";
+
+
+    //------------------- a vector register at a time ------------------
+    std::vector<float> samples(1003);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = float(i % 17);
+    }
+    NamedTemplate<float> signal(samples);
+    auto parts = chunks(signal);
+    std::cout << parts.head().size() << " head elements, " << parts.blocks().size() << " blocks of " << parts.lanes()
+              << ", " << parts.tail().size() << " tail elements\n";
+
+    //the bulk operations are built on the blocks.
+    bulk::transform(signal, signal, [](float v) { return 2*v; });
+    const auto range = bulk::minMax(signal);
+    std::cout << "sum " << bulk::sum(signal) << ", min " << range.first << ", max " << range.second << "\n";
+    bulk::fill(signal, 0.5f);
+    std::cout << "filled with 0.5, sum " << bulk::sum(signal) << "\n";
+
+    return 0;
+}